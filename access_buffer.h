@@ -0,0 +1,71 @@
+// access_buffer.h
+#ifndef ACCESS_BUFFER_H
+#define ACCESS_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+
+class CacheEntry;
+
+// Close-time bookkeeping waiting to be applied to a cache entry
+struct PendingAccess {
+    std::shared_ptr<CacheEntry> entry;
+    uint32_t accessTick;  // CoarseClock ticks
+    bool counted;         // false if the close only releases the handle
+};
+
+// Fixed-size single-producer ring of PendingAccess records.
+//
+// Each thread closing files owns one buffer and pushes into it without locking.
+// Whichever thread holds cacheMutex next drains every buffer, so there is only
+// ever one consumer at a time.
+class AccessBuffer {
+public:
+    static constexpr size_t CAPACITY = 256;
+
+    explicit AccessBuffer(std::thread::id owner) : owner(owner), next(nullptr), head(0), tail(0) {}
+
+    // Producer side (owning thread only). Returns false without taking the entry if full.
+    bool push(std::shared_ptr<CacheEntry>&& entry, uint32_t accessTick, bool counted) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == CAPACITY) {
+            return false;
+        }
+        PendingAccess& slot = slots[h % CAPACITY];
+        slot.entry = std::move(entry);
+        slot.accessTick = accessTick;
+        slot.counted = counted;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side (caller holds cacheMutex). Calls fn(PendingAccess&) for each record in order.
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        for (size_t i = t; i != h; i++) {
+            PendingAccess& slot = slots[i % CAPACITY];
+            fn(slot);
+            slot.entry.reset();
+        }
+        tail.store(h, std::memory_order_release);
+        return h - t;
+    }
+
+    const std::thread::id owner;
+    AccessBuffer* next;  // registry list, immutable once published
+
+private:
+    std::array<PendingAccess, CAPACITY> slots;
+
+    // Producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+#endif // ACCESS_BUFFER_H
@@ -0,0 +1,225 @@
+// access_trace.cpp
+#include "access_trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const char TRACE_MAGIC[8] = {'C', 'A', 'C', 'H', 'E', 'T', 'R', 'C'};
+const uint32_t TRACE_VERSION = 1;
+const size_t TRACE_BUFFER_RECORDS = 4096;
+
+std::atomic<uint64_t> nextRecorderId{1};
+
+// Per-thread cache of the id from the most recently used recorder, so a
+// thread recording into one trace skips the map lookup
+thread_local uint64_t cachedRecorderId = 0;
+thread_local uint16_t cachedThreadId = 0;
+
+} // namespace
+
+uint8_t encodeTraceMode(const std::string& mode) {
+    uint8_t bits = 0;
+    for (char c : mode) {
+        switch (c) {
+            case 'r': bits |= TRACE_MODE_READ; break;
+            case 'w': bits |= TRACE_MODE_WRITE; break;
+            case 'a': bits |= TRACE_MODE_APPEND; break;
+            case '+': bits |= TRACE_MODE_PLUS; break;
+            case 'x': bits |= TRACE_MODE_EXCLUSIVE; break;
+            case 'b': bits |= TRACE_MODE_BINARY; break;
+            default: break;
+        }
+    }
+    return bits;
+}
+
+std::string decodeTraceMode(uint8_t modeBits) {
+    std::string mode;
+    if (modeBits & TRACE_MODE_READ) mode += 'r';
+    if (modeBits & TRACE_MODE_WRITE) mode += 'w';
+    if (modeBits & TRACE_MODE_APPEND) mode += 'a';
+    if (modeBits & TRACE_MODE_EXCLUSIVE) mode += 'x';
+    if (modeBits & TRACE_MODE_BINARY) mode += 'b';
+    if (modeBits & TRACE_MODE_PLUS) mode += '+';
+    return mode;
+}
+
+// TraceRecorder implementation
+TraceRecorder::TraceRecorder(const std::string& tracePath)
+    : out(tracePath, std::ios::binary | std::ios::trunc),
+      recordCount(0), recorderId(nextRecorderId++),
+      startTime(std::chrono::steady_clock::now()), closed(false) {
+
+    buffer.reserve(TRACE_BUFFER_RECORDS);
+
+    if (!out) {
+        std::cerr << "Error opening trace file: " << tracePath << std::endl;
+        return;
+    }
+
+    // Placeholder header, rewritten by close()
+    TraceHeader header = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+TraceRecorder::~TraceRecorder() {
+    close();
+}
+
+uint16_t TraceRecorder::currentThreadId() {
+    // Called under traceMutex. A thread alternating between recorders keeps
+    // the id each one gave it.
+    if (cachedRecorderId != recorderId) {
+        auto inserted = threadIds.emplace(std::this_thread::get_id(), static_cast<uint16_t>(threadIds.size()));
+        cachedRecorderId = recorderId;
+        cachedThreadId = inserted.first->second;
+    }
+    return cachedThreadId;
+}
+
+uint32_t TraceRecorder::internPath(const std::string& filePath) {
+    std::lock_guard<std::mutex> lock(traceMutex);
+
+    auto it = pathIds.find(filePath);
+    if (it != pathIds.end()) {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(paths.size());
+    paths.push_back(filePath);
+    pathIds.emplace(filePath, id);
+    return id;
+}
+
+void TraceRecorder::record(TraceOp op, uint32_t pathId, uint64_t offset, uint64_t length, uint8_t mode) {
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (closed || !out) {
+        return;
+    }
+
+    // Taken under the lock, so records are written in timestamp order
+    auto now = std::chrono::steady_clock::now();
+
+    TraceRecord rec = {};
+    rec.timestampNs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - startTime).count());
+    rec.offset = offset;
+    rec.length = static_cast<uint32_t>(std::min<uint64_t>(length, UINT32_MAX));
+    rec.pathId = pathId;
+    rec.threadId = currentThreadId();
+    rec.op = op;
+    rec.mode = mode;
+
+    buffer.push_back(rec);
+    recordCount++;
+
+    if (buffer.size() >= TRACE_BUFFER_RECORDS) {
+        flushBuffer();
+    }
+}
+
+void TraceRecorder::flushBuffer() {
+    if (buffer.empty()) {
+        return;
+    }
+    out.write(reinterpret_cast<const char*>(buffer.data()),
+              static_cast<std::streamsize>(buffer.size() * sizeof(TraceRecord)));
+    buffer.clear();
+}
+
+bool TraceRecorder::close() {
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (closed) {
+        return true;
+    }
+    closed = true;
+
+    if (!out) {
+        return false;
+    }
+
+    flushBuffer();
+
+    TraceHeader header = {};
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.pathCount = static_cast<uint32_t>(paths.size());
+    header.recordCount = recordCount;
+    header.pathTableOffset = static_cast<uint64_t>(out.tellp());
+
+    for (const auto& path : paths) {
+        uint32_t length = static_cast<uint32_t>(path.size());
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(path.data(), length);
+    }
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+
+    return !out.fail();
+}
+
+uint64_t TraceRecorder::getRecordCount() {
+    std::lock_guard<std::mutex> lock(traceMutex);
+    return recordCount;
+}
+
+// TraceReader implementation
+bool TraceReader::open(const std::string& tracePath) {
+    in.open(tracePath, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != TRACE_VERSION) {
+        return false;
+    }
+
+    // Load the path table, then return to the first record
+    in.seekg(static_cast<std::streamoff>(header.pathTableOffset));
+    paths.clear();
+    paths.reserve(header.pathCount);
+    for (uint32_t i = 0; i < header.pathCount; i++) {
+        uint32_t length = 0;
+        in.read(reinterpret_cast<char*>(&length), sizeof(length));
+        std::string path(length, '\0');
+        in.read(&path[0], length);
+        if (!in) {
+            return false;
+        }
+        paths.push_back(std::move(path));
+    }
+
+    in.seekg(sizeof(TraceHeader));
+    recordsRead = 0;
+    return true;
+}
+
+bool TraceReader::next(TraceRecord& record) {
+    if (recordsRead >= header.recordCount) {
+        return false;
+    }
+    in.read(reinterpret_cast<char*>(&record), sizeof(record));
+    if (!in) {
+        return false;
+    }
+    recordsRead++;
+    return true;
+}
+
+std::vector<TraceRecord> TraceReader::readAll() {
+    std::vector<TraceRecord> records;
+    records.resize(header.recordCount - recordsRead);
+    in.read(reinterpret_cast<char*>(records.data()),
+            static_cast<std::streamsize>(records.size() * sizeof(TraceRecord)));
+    size_t count = static_cast<size_t>(in.gcount()) / sizeof(TraceRecord);
+    records.resize(count);
+    recordsRead += count;
+    return records;
+}
@@ -0,0 +1,128 @@
+// access_trace.h
+#ifndef ACCESS_TRACE_H
+#define ACCESS_TRACE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <fstream>
+#include <cstdint>
+#include <type_traits>
+
+// Binary trace file layout (host byte order):
+//   TraceHeader
+//   TraceRecord[recordCount]
+//   path table at pathTableOffset: pathCount x { uint32_t length; char bytes[length]; }
+// The path table is written last so records can be streamed while recording.
+
+// Operation recorded in a trace
+enum class TraceOp : uint8_t {
+    Open = 1,   // offset = 0, length = file size at open, mode = open mode bits
+    Read = 2,   // offset = position before the read, length = bytes requested
+    Write = 3,  // offset = position before the write, length = bytes written
+    Close = 4
+};
+
+// Open mode bits stored in TraceRecord::mode
+enum TraceModeBits : uint8_t {
+    TRACE_MODE_READ = 1 << 0,
+    TRACE_MODE_WRITE = 1 << 1,
+    TRACE_MODE_APPEND = 1 << 2,
+    TRACE_MODE_PLUS = 1 << 3,
+    TRACE_MODE_EXCLUSIVE = 1 << 4,
+    TRACE_MODE_BINARY = 1 << 5
+};
+
+struct TraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t pathCount;
+    uint64_t recordCount;
+    uint64_t pathTableOffset;
+};
+
+struct TraceRecord {
+    uint64_t timestampNs;   // Nanoseconds since the recorder was created
+    uint64_t offset;
+    uint32_t length;
+    uint32_t pathId;        // Index into the trace path table
+    uint16_t threadId;      // Small per-trace thread number, assigned on first use
+    TraceOp op;
+    uint8_t mode;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(TraceHeader) == 32, "TraceHeader must stay 32 bytes");
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord must stay 32 bytes");
+static_assert(std::is_trivially_copyable<TraceRecord>::value, "TraceRecord is written raw");
+
+// Converts between fopen-style mode strings and TraceModeBits
+uint8_t encodeTraceMode(const std::string& mode);
+std::string decodeTraceMode(uint8_t modeBits);
+
+// Thread-safe trace writer. Records are buffered and streamed to disk;
+// the path table and final counts are written by close().
+class TraceRecorder {
+private:
+    std::ofstream out;
+    std::mutex traceMutex;
+    std::vector<TraceRecord> buffer;
+    std::vector<std::string> paths;
+    std::unordered_map<std::string, uint32_t> pathIds;
+    uint64_t recordCount;
+    uint64_t recorderId;
+    std::unordered_map<std::thread::id, uint16_t> threadIds;  // stable per thread for the trace
+    std::chrono::steady_clock::time_point startTime;
+    bool closed;
+
+    uint16_t currentThreadId();
+    void flushBuffer();
+
+public:
+    explicit TraceRecorder(const std::string& tracePath);
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    bool isOpen() const { return out.is_open() && !closed; }
+
+    // Returns the trace-local id for a path, adding it to the path table if new
+    uint32_t internPath(const std::string& filePath);
+
+    void record(TraceOp op, uint32_t pathId, uint64_t offset, uint64_t length, uint8_t mode = 0);
+
+    // Writes the path table and header; further records are dropped
+    bool close();
+
+    uint64_t getRecordCount();
+};
+
+// Sequential trace reader
+class TraceReader {
+private:
+    std::ifstream in;
+    TraceHeader header;
+    std::vector<std::string> paths;
+    uint64_t recordsRead;
+
+public:
+    TraceReader() : header(), recordsRead(0) {}
+
+    // Loads the header and path table; returns false if the file is not a valid trace
+    bool open(const std::string& tracePath);
+
+    // Reads the next record; returns false at end of trace
+    bool next(TraceRecord& record);
+
+    // Reads all remaining records
+    std::vector<TraceRecord> readAll();
+
+    const std::vector<std::string>& getPaths() const { return paths; }
+    uint64_t getRecordCount() const { return header.recordCount; }
+};
+
+#endif // ACCESS_TRACE_H
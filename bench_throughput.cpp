@@ -0,0 +1,316 @@
+// bench_throughput.cpp
+#include "content_aware_cache.h"
+#include "numa_topology.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <algorithm>
+
+// Benchmark configuration
+struct BenchOptions {
+    std::vector<size_t> threadCounts = {1, 2, 4, 8};
+    double hitRatio = 0.9;
+    double writeRatio = 0.0;
+    size_t readSize = 4096;
+    size_t fileSize = 16 * 1024;
+    size_t hotFiles = 256;
+    size_t coldFiles = 1024;
+    size_t opsPerThread = 100000;
+    unsigned seed = 42;
+    bool hugePages = false;
+    bool numaReplicas = false;
+    bool backgroundFlush = false;
+    double writeBackLimit = 0;  // MB/s, 0 for unlimited
+    std::string dataDir = "./bench_files";
+};
+
+// Per-thread results
+struct ThreadResult {
+    std::vector<uint64_t> latencyNs;
+    size_t hits = 0;
+    size_t opens = 0;
+};
+
+std::vector<size_t> parseList(const std::string& text) {
+    std::vector<size_t> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(std::max<size_t>(1, std::stoul(item)));
+        }
+    }
+    return items;
+}
+
+std::vector<std::string> createFiles(const std::string& dir, const std::string& prefix, size_t count,
+                                     size_t size, std::mt19937& rng) {
+    std::vector<std::string> files;
+    std::uniform_int_distribution<int> charDist(65, 90);  // A-Z
+    for (size_t i = 0; i < count; i++) {
+        // One file type throughout, so access history alone decides which files stay resident
+        std::string filePath = dir + "/" + prefix + std::to_string(i) + ".dat";
+        std::ofstream file(filePath, std::ios::binary);
+        std::vector<char> buffer(size, static_cast<char>(charDist(rng)));
+        file.write(buffer.data(), buffer.size());
+        files.push_back(filePath);
+    }
+    return files;
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    return sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+}
+
+void benchWorker(ContentAwareCache& cache, const std::vector<PathKey>& hotFiles,
+                 const std::vector<PathKey>& coldFiles, const BenchOptions& options,
+                 size_t threadIndex, std::atomic<size_t>& ready, std::atomic<bool>& go,
+                 ThreadResult& result) {
+    std::mt19937 rng(options.seed + static_cast<unsigned>(threadIndex));
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    std::uniform_int_distribution<size_t> hotDist(0, hotFiles.size() - 1);
+    std::uniform_int_distribution<size_t> coldDist(0, coldFiles.size() - 1);
+    std::vector<char> buffer(options.readSize, 'W');
+    constexpr uint8_t readMode = parseOpenMode("r");
+    constexpr uint8_t updateMode = parseOpenMode("r+");
+
+    result.latencyNs.reserve(options.opsPerThread);
+
+    ready++;
+    while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+
+    for (size_t op = 0; op < options.opsPerThread; op++) {
+        bool hot = chance(rng) < options.hitRatio;
+        const PathKey& filePath = hot ? hotFiles[hotDist(rng)] : coldFiles[coldDist(rng)];
+        // Writes only target the resident hot set and update it in place ("r+"), so they
+        // never replace a file with a fragment
+        bool write = hot && chance(rng) < options.writeRatio;
+
+        auto start = std::chrono::steady_clock::now();
+
+        CacheFile file = cache.open(filePath, write ? updateMode : readMode);
+        if (file) {
+            result.opens++;
+            result.hits += file.wasCacheHit() ? 1 : 0;
+            if (write) {
+                file.write(buffer.data(), 1, buffer.size());
+            } else {
+                file.read(buffer.data(), 1, buffer.size());
+            }
+            file.close();
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        result.latencyNs.push_back(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+    }
+}
+
+void displayUsage() {
+    std::cout << "Usage: bench_throughput [options]" << std::endl;
+    std::cout << "  --threads <list>     Comma-separated thread counts (default 1,2,4,8)" << std::endl;
+    std::cout << "  --hit-ratio <r>      Fraction of opens aimed at the resident hot set (default 0.9)" << std::endl;
+    std::cout << "  --write-ratio <r>    Fraction of hot-set opens that write instead of read (default 0)" << std::endl;
+    std::cout << "  --read-size <bytes>  Bytes read or written per open (default 4096)" << std::endl;
+    std::cout << "  --file-size <bytes>  Size of every data file (default 16384)" << std::endl;
+    std::cout << "  --hot-files <n>      Files in the hot set (default 256)" << std::endl;
+    std::cout << "  --cold-files <n>     Files in the cold set (default 1024)" << std::endl;
+    std::cout << "  --ops <n>            Operations per thread (default 100000)" << std::endl;
+    std::cout << "  --seed <n>           Seed for data and access streams (default 42)" << std::endl;
+    std::cout << "  --huge-pages <0|1>   Keep payloads in a huge-page backed region (default 0)" << std::endl;
+    std::cout << "  --numa-replicas <0|1> Give hot replicas node-local payload copies (default 0)" << std::endl;
+    std::cout << "  --background-flush <0|1> Run flushAsync() in a loop during the run (default 0)" << std::endl;
+    std::cout << "  --writeback-limit <MB/s> Write-back bandwidth limit, 0 for none (default 0)" << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--threads") {
+            options.threadCounts = parseList(value);
+        } else if (arg == "--hit-ratio") {
+            options.hitRatio = std::stod(value);
+        } else if (arg == "--write-ratio") {
+            options.writeRatio = std::stod(value);
+        } else if (arg == "--read-size") {
+            options.readSize = std::max<size_t>(1, std::stoul(value));
+        } else if (arg == "--file-size") {
+            options.fileSize = std::max<size_t>(1, std::stoul(value));
+        } else if (arg == "--hot-files") {
+            options.hotFiles = std::max<size_t>(1, std::stoul(value));
+        } else if (arg == "--cold-files") {
+            options.coldFiles = std::max<size_t>(1, std::stoul(value));
+        } else if (arg == "--ops") {
+            options.opsPerThread = std::stoul(value);
+        } else if (arg == "--seed") {
+            options.seed = static_cast<unsigned>(std::stoul(value));
+        } else if (arg == "--huge-pages") {
+            options.hugePages = std::stoul(value) != 0;
+        } else if (arg == "--numa-replicas") {
+            options.numaReplicas = std::stoul(value) != 0;
+        } else if (arg == "--background-flush") {
+            options.backgroundFlush = std::stoul(value) != 0;
+        } else if (arg == "--writeback-limit") {
+            options.writeBackLimit = std::stod(value);
+        } else {
+            std::cout << "Error: Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    return !options.threadCounts.empty();
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            displayUsage();
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Error: Invalid option value." << std::endl;
+        displayUsage();
+        return 1;
+    }
+
+    std::cout << "Content-Aware Cache Throughput Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    fs::remove_all(options.dataDir);
+    fs::create_directories(options.dataDir);
+    std::mt19937 dataRng(options.seed);
+    std::vector<std::string> hotFiles = createFiles(options.dataDir, "hot_", options.hotFiles, options.fileSize, dataRng);
+    std::vector<std::string> coldFiles = createFiles(options.dataDir, "cold_", options.coldFiles, options.fileSize, dataRng);
+    // Workers open by key, so paths are hashed once here rather than on every open
+    std::vector<PathKey> hotKeys(hotFiles.begin(), hotFiles.end());
+    std::vector<PathKey> coldKeys(coldFiles.begin(), coldFiles.end());
+
+    // Room for the hot set plus a few cold files, so cold opens miss and evict each other
+    size_t cacheSize = (options.hotFiles + 8) * options.fileSize;
+
+    std::cout << "Hot files: " << options.hotFiles << ", cold files: " << options.coldFiles
+              << ", file size: " << options.fileSize << " bytes, cache size: " << cacheSize << " bytes" << std::endl;
+    std::cout << "Target hit ratio: " << options.hitRatio << ", write ratio: " << options.writeRatio
+              << ", read size: " << options.readSize << " bytes, ops/thread: " << options.opsPerThread
+              << ", seed: " << options.seed << std::endl;
+    if (options.hugePages) {
+        ContentAwareCache probe(cacheSize);
+        std::cout << "Huge-page region: " << (probe.enableHugePageArena() ? "reserved" : "unavailable, using heap")
+                  << std::endl;
+    }
+    std::cout << "NUMA nodes: " << NumaTopology::get().getNodeCount() << std::endl;
+    if (options.backgroundFlush) {
+        std::cout << "Background flush: on, write-back limit: ";
+        if (options.writeBackLimit > 0) {
+            std::cout << options.writeBackLimit << " MB/s" << std::endl;
+        } else {
+            std::cout << "none" << std::endl;
+        }
+    }
+    std::cout << std::endl;
+
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "ops/sec" << std::setw(12) << "scaling"
+              << std::setw(10) << "hit%" << std::setw(10) << "p50 ns" << std::setw(10) << "p90 ns"
+              << std::setw(10) << "p99 ns" << std::setw(11) << "p99.9 ns" << std::endl;
+
+    double singleThreadOps = 0.0;
+
+    for (size_t threads : options.threadCounts) {
+        auto cache = std::make_shared<ContentAwareCache>(cacheSize);
+        if (options.hugePages) {
+            cache->enableHugePageArena();
+        }
+        cache->setNumaReplication(options.numaReplicas);
+        IoClassLimits writeBackLimits;
+        writeBackLimits.bytesPerSecond = options.writeBackLimit * 1024 * 1024;
+        cache->setIoLimits(IoClass::WriteBack, writeBackLimits);
+
+        // Warm the hot set so it starts resident with some access history
+        for (int pass = 0; pass < 2; pass++) {
+            for (const auto& filePath : hotFiles) {
+                cache->open(filePath, "r");
+            }
+        }
+
+        std::vector<ThreadResult> results(threads);
+        std::vector<std::thread> workers;
+        std::atomic<size_t> ready{0};
+        std::atomic<bool> go{false};
+
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back(benchWorker, std::ref(*cache), std::cref(hotKeys), std::cref(coldKeys),
+                                 std::cref(options), t, std::ref(ready), std::ref(go), std::ref(results[t]));
+        }
+        while (ready.load() < threads) {
+            std::this_thread::yield();
+        }
+
+        // Write-back competing with the workers for the disk
+        std::atomic<bool> done{false};
+        std::thread flusher;
+        if (options.backgroundFlush) {
+            flusher = std::thread([&] {
+                while (!done.load()) {
+                    cache->flushAsync().get();
+                }
+            });
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        auto endTime = std::chrono::steady_clock::now();
+        done.store(true);
+        if (flusher.joinable()) {
+            flusher.join();
+        }
+
+        std::vector<uint64_t> latencies;
+        size_t hits = 0;
+        size_t opens = 0;
+        for (auto& result : results) {
+            latencies.insert(latencies.end(), result.latencyNs.begin(), result.latencyNs.end());
+            hits += result.hits;
+            opens += result.opens;
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        double seconds = std::chrono::duration<double>(endTime - startTime).count();
+        double opsPerSec = seconds > 0.0 ? latencies.size() / seconds : 0.0;
+        if (singleThreadOps == 0.0) {
+            // Efficiency is relative to the first (normally single-threaded) run, per thread
+            singleThreadOps = opsPerSec / threads;
+        }
+        double scaling = singleThreadOps > 0.0 ? opsPerSec / (singleThreadOps * threads) : 0.0;
+
+        std::cout << std::setw(8) << threads
+                  << std::setw(14) << std::fixed << std::setprecision(0) << opsPerSec
+                  << std::setw(11) << std::setprecision(1) << (scaling * 100.0) << "%"
+                  << std::setw(9) << (opens ? 100.0 * hits / opens : 0.0) << "%"
+                  << std::setw(10) << percentile(latencies, 0.50)
+                  << std::setw(10) << percentile(latencies, 0.90)
+                  << std::setw(10) << percentile(latencies, 0.99)
+                  << std::setw(11) << percentile(latencies, 0.999) << std::endl;
+    }
+
+    fs::remove_all(options.dataDir);
+    return 0;
+}
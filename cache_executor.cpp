@@ -0,0 +1,201 @@
+// cache_executor.cpp
+#include "cache_executor.h"
+#include <algorithm>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Executor and index of the worker running on this thread, if any
+thread_local const CacheExecutor* currentExecutor = nullptr;
+thread_local size_t currentWorker = 0;
+
+bool pinThread(std::thread& thread, int cpu) {
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void)thread;
+    (void)cpu;
+    return false;
+#endif
+}
+
+} // namespace
+
+CacheExecutor::CacheExecutor(const ExecutorOptions& options)
+    : pinnedThreads(0), nextWorker(0), queued(0), stolenTasks(0), failedTasks(0), stopping(false) {
+    for (size_t lane = 0; lane < TASK_LANE_COUNT; lane++) {
+        laneQueued[lane].store(0, std::memory_order_relaxed);
+        laneCompleted[lane].store(0, std::memory_order_relaxed);
+    }
+
+    size_t threads = options.threads;
+    if (threads == 0) {
+        threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), 4);
+    }
+
+    // All workers exist before any runs, since they steal from each other
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back(new Worker());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        workers[i]->thread = std::thread(&CacheExecutor::run, this, i);
+        if (!options.cpus.empty() && pinThread(workers[i]->thread, options.cpus[i % options.cpus.size()])) {
+            pinnedThreads++;
+        }
+    }
+}
+
+CacheExecutor::~CacheExecutor() {
+    shutdown();
+}
+
+bool CacheExecutor::submit(TaskLane lane, Task task) {
+    size_t laneIndex = static_cast<size_t>(lane);
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        if (stopping) {
+            return false;
+        }
+        laneQueued[laneIndex].fetch_add(1);
+        queued.fetch_add(1);
+    }
+
+    // Workers keep their own follow-up work; outside callers spread it out
+    size_t target = currentExecutor == this
+        ? currentWorker
+        : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    {
+        std::lock_guard<std::mutex> lock(workers[target]->mutex);
+        workers[target]->lanes[laneIndex].push_back(std::move(task));
+    }
+    wake.notify_one();
+    return true;
+}
+
+void CacheExecutor::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+
+    // Speculative work is not worth delaying shutdown for
+    size_t prefetch = static_cast<size_t>(TaskLane::Prefetch);
+    for (auto& worker : workers) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        size_t dropped = worker->lanes[prefetch].size();
+        worker->lanes[prefetch].clear();
+        laneQueued[prefetch].fetch_sub(dropped);
+        queued.fetch_sub(dropped);
+    }
+
+    wake.notify_all();
+    std::call_once(joined, [this] {
+        std::thread::id self = std::this_thread::get_id();
+        for (auto& worker : workers) {
+            if (worker->thread.get_id() == self) {
+                // A task released the last owner of this pool. The worker can't
+                // join itself; it leaves run() without touching the pool again.
+                worker->thread.detach();
+                currentExecutor = nullptr;
+            } else if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+    });
+}
+
+bool CacheExecutor::takeTask(size_t index, Task& task, size_t& lane) {
+    for (lane = 0; lane < TASK_LANE_COUNT; lane++) {
+        if (laneQueued[lane].load() == 0) {
+            continue;
+        }
+
+        // Own work newest first
+        {
+            Worker& own = *workers[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.lanes[lane].empty()) {
+                task = std::move(own.lanes[lane].back());
+                own.lanes[lane].pop_back();
+                laneQueued[lane].fetch_sub(1);
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+
+        // Others' work oldest first
+        for (size_t offset = 1; offset < workers.size(); offset++) {
+            Worker& victim = *workers[(index + offset) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.lanes[lane].empty()) {
+                task = std::move(victim.lanes[lane].front());
+                victim.lanes[lane].pop_front();
+                laneQueued[lane].fetch_sub(1);
+                queued.fetch_sub(1);
+                stolenTasks.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void CacheExecutor::run(size_t index) {
+    currentExecutor = this;
+    currentWorker = index;
+
+    while (true) {
+        Task task;
+        size_t lane;
+        if (takeTask(index, task, lane)) {
+            bool failed = false;
+            try {
+                task();
+            } catch (...) {
+                failed = true;
+            }
+            // Captured state may own the pool's owner, so it goes before the
+            // pool is used again
+            task = nullptr;
+            if (currentExecutor != this) {
+                return;  // shut down from this worker and possibly deleted
+            }
+            if (failed) {
+                failedTasks.fetch_add(1, std::memory_order_relaxed);
+            }
+            laneCompleted[lane].fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (queued.load() > 0) {
+            // Counted but not pushed yet; its submitter is about to finish
+            lock.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+        if (stopping) {
+            break;
+        }
+        wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+    }
+
+    currentExecutor = nullptr;
+}
+
+size_t CacheExecutor::getQueuedTasks(TaskLane lane) const {
+    return laneQueued[static_cast<size_t>(lane)].load(std::memory_order_relaxed);
+}
+
+size_t CacheExecutor::getCompletedTasks(TaskLane lane) const {
+    return laneCompleted[static_cast<size_t>(lane)].load(std::memory_order_relaxed);
+}
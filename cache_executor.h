@@ -0,0 +1,95 @@
+// cache_executor.h
+#ifndef CACHE_EXECUTOR_H
+#define CACHE_EXECUTOR_H
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+// Lanes of background work, highest priority first
+enum class TaskLane : uint8_t {
+    Demand,     // work a caller is waiting for, e.g. an asynchronous miss
+    WriteBack,  // writing cached contents to disk
+    Prefetch    // speculative loads; dropped at shutdown
+};
+
+constexpr size_t TASK_LANE_COUNT = 3;
+
+struct ExecutorOptions {
+    size_t threads = 0;     // worker threads; 0 picks min(hardware threads, 4)
+    std::vector<int> cpus;  // worker i is pinned to cpus[i % cpus.size()]; empty leaves them unpinned
+};
+
+// Work-stealing thread pool for a cache's background work.
+//
+// Every worker has a deque per lane. Tasks submitted from a worker go to its
+// own deques and are taken newest first, so follow-up work stays on a warm
+// core; other submissions are spread round-robin. An idle worker steals the
+// oldest task of a lane from the other workers. Workers always take the
+// highest lane that has any task anywhere, so demand work overtakes queued
+// write-back, which overtakes prefetch.
+//
+// shutdown() stops accepting tasks, discards queued prefetches, runs the
+// remaining demand and write-back tasks and joins the workers. It may be
+// called from a task, e.g. when the task drops the last reference to the
+// cache owning the pool: that worker is detached instead of joined and exits
+// once the task returns, so the pool can be destroyed under it.
+class CacheExecutor {
+public:
+    typedef std::function<void()> Task;
+
+    explicit CacheExecutor(const ExecutorOptions& options = ExecutorOptions());
+    ~CacheExecutor();
+
+    CacheExecutor(const CacheExecutor&) = delete;
+    CacheExecutor& operator=(const CacheExecutor&) = delete;
+
+    // Queues a task; false once shutdown has begun. A task that throws is
+    // counted as failed and does not stop its worker.
+    bool submit(TaskLane lane, Task task);
+
+    void shutdown();
+
+    size_t getThreadCount() const { return workers.size(); }
+    size_t getPinnedThreadCount() const { return pinnedThreads; }
+    size_t getQueuedTasks(TaskLane lane) const;
+    size_t getCompletedTasks(TaskLane lane) const;
+    size_t getStolenTasks() const { return stolenTasks.load(std::memory_order_relaxed); }
+    size_t getFailedTasks() const { return failedTasks.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> lanes[TASK_LANE_COUNT];
+        std::thread thread;
+    };
+
+    void run(size_t index);
+    bool takeTask(size_t index, Task& task, size_t& lane);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    size_t pinnedThreads;
+    std::atomic<size_t> nextWorker;  // round-robin target for outside submissions
+
+    // queued counts tasks accepted but not yet taken, per lane and in total.
+    // Both are raised under sleepMutex so a worker going to sleep cannot miss one.
+    std::atomic<size_t> laneQueued[TASK_LANE_COUNT];
+    std::atomic<size_t> queued;
+    std::atomic<size_t> laneCompleted[TASK_LANE_COUNT];
+    std::atomic<size_t> stolenTasks;
+    std::atomic<size_t> failedTasks;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::once_flag joined;
+};
+
+#endif // CACHE_EXECUTOR_H
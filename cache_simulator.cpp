@@ -0,0 +1,428 @@
+// cache_simulator.cpp
+#include "cache_simulator.h"
+#include "content_aware_cache.h"
+#include "file_type_table.h"
+#include "access_trace.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <limits>
+
+namespace {
+
+const uint32_t NIL = std::numeric_limits<uint32_t>::max();
+
+// Recency list over object ids with O(1) move-to-front; LRU and FIFO differ only in hit handling
+class ListSim : public SimPolicy {
+private:
+    bool moveOnHit;
+    std::vector<uint32_t> prev;
+    std::vector<uint32_t> next;
+    std::vector<uint64_t> residentSize;
+    std::vector<uint8_t> resident;
+    uint32_t head;
+    uint32_t tail;
+
+    void unlink(uint32_t id) {
+        if (prev[id] != NIL) next[prev[id]] = next[id]; else head = next[id];
+        if (next[id] != NIL) prev[next[id]] = prev[id]; else tail = prev[id];
+    }
+
+    void pushFront(uint32_t id) {
+        prev[id] = NIL;
+        next[id] = head;
+        if (head != NIL) prev[head] = id; else tail = id;
+        head = id;
+    }
+
+public:
+    ListSim(uint64_t capacity, size_t objectCount, bool moveOnHit)
+        : SimPolicy(capacity), moveOnHit(moveOnHit),
+          prev(objectCount, NIL), next(objectCount, NIL),
+          residentSize(objectCount, 0), resident(objectCount, 0), head(NIL), tail(NIL) {}
+
+    const char* name() const override { return moveOnHit ? "lru" : "fifo"; }
+
+    bool access(uint32_t id, uint64_t size, uint16_t, float) override {
+        if (resident[id]) {
+            if (moveOnHit && head != id) {
+                unlink(id);
+                pushFront(id);
+            }
+            return true;
+        }
+
+        // Same admission rule as LRUCache: evict from the tail, skip objects larger than the cache
+        while (used + size > capacity && tail != NIL) {
+            uint32_t victim = tail;
+            unlink(victim);
+            resident[victim] = 0;
+            used -= residentSize[victim];
+        }
+        if (size <= capacity) {
+            pushFront(id);
+            resident[id] = 1;
+            residentSize[id] = size;
+            used += size;
+        }
+        return false;
+    }
+};
+
+// Binary min-heap over object ids with a position index for O(log n) updates
+struct HeapKey {
+    double priority;
+    uint64_t tieBreak;
+
+    bool operator<(const HeapKey& other) const {
+        return priority < other.priority || (priority == other.priority && tieBreak < other.tieBreak);
+    }
+};
+
+class IndexedMinHeap {
+private:
+    std::vector<uint32_t> heap;
+    std::vector<uint32_t> position;
+    std::vector<HeapKey> keys;
+
+    void swapAt(size_t a, size_t b) {
+        std::swap(heap[a], heap[b]);
+        position[heap[a]] = static_cast<uint32_t>(a);
+        position[heap[b]] = static_cast<uint32_t>(b);
+    }
+
+    void siftUp(size_t i) {
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (!(keys[heap[i]] < keys[heap[parent]])) break;
+            swapAt(i, parent);
+            i = parent;
+        }
+    }
+
+    void siftDown(size_t i) {
+        for (;;) {
+            size_t smallest = i;
+            size_t left = 2 * i + 1;
+            size_t right = left + 1;
+            if (left < heap.size() && keys[heap[left]] < keys[heap[smallest]]) smallest = left;
+            if (right < heap.size() && keys[heap[right]] < keys[heap[smallest]]) smallest = right;
+            if (smallest == i) break;
+            swapAt(i, smallest);
+            i = smallest;
+        }
+    }
+
+public:
+    explicit IndexedMinHeap(size_t objectCount) : position(objectCount, NIL), keys(objectCount) {}
+
+    bool contains(uint32_t id) const { return position[id] != NIL; }
+    bool empty() const { return heap.empty(); }
+    const HeapKey& keyOf(uint32_t id) const { return keys[id]; }
+
+    void set(uint32_t id, const HeapKey& key) {
+        keys[id] = key;
+        if (position[id] == NIL) {
+            heap.push_back(id);
+            position[id] = static_cast<uint32_t>(heap.size() - 1);
+            siftUp(heap.size() - 1);
+        } else {
+            siftUp(position[id]);
+            siftDown(position[id]);
+        }
+    }
+
+    // Updates a key without restoring heap order; call heapify() afterwards
+    void assign(uint32_t id, const HeapKey& key) {
+        keys[id] = key;
+    }
+
+    void heapify() {
+        for (size_t i = heap.size() / 2; i-- > 0;) {
+            siftDown(i);
+        }
+    }
+
+    uint32_t popMin() {
+        uint32_t id = heap.front();
+        swapAt(0, heap.size() - 1);
+        heap.pop_back();
+        position[id] = NIL;
+        if (!heap.empty()) siftDown(0);
+        return id;
+    }
+};
+
+// LFU (ties broken by least recent) and GDSF (frequency / size with inflation)
+class HeapSim : public SimPolicy {
+private:
+    bool sizeAware;
+    IndexedMinHeap heap;
+    std::vector<uint32_t> frequency;
+    std::vector<uint64_t> residentSize;
+    uint64_t tick;
+    double inflation;
+
+    HeapKey keyFor(uint32_t id) const {
+        double priority = frequency[id];
+        if (sizeAware) {
+            priority = inflation + frequency[id] / static_cast<double>(std::max<uint64_t>(1, residentSize[id]));
+        }
+        return {priority, tick};
+    }
+
+public:
+    HeapSim(uint64_t capacity, size_t objectCount, bool sizeAware)
+        : SimPolicy(capacity), sizeAware(sizeAware), heap(objectCount),
+          frequency(objectCount, 0), residentSize(objectCount, 0), tick(0), inflation(0.0) {}
+
+    const char* name() const override { return sizeAware ? "gdsf" : "lfu"; }
+
+    bool access(uint32_t id, uint64_t size, uint16_t, float) override {
+        tick++;
+        if (heap.contains(id)) {
+            frequency[id]++;
+            heap.set(id, keyFor(id));
+            return true;
+        }
+
+        while (used + size > capacity && !heap.empty()) {
+            uint32_t victim = heap.popMin();
+            if (sizeAware) {
+                inflation = heap.keyOf(victim).priority;
+            }
+            used -= residentSize[victim];
+            frequency[victim] = 0;
+        }
+        if (size <= capacity) {
+            frequency[id] = 1;
+            residentSize[id] = size;
+            used += size;
+            heap.set(id, keyFor(id));
+        }
+        return false;
+    }
+};
+
+// Mirrors ContentAwareCache: when a miss needs room, victims are taken in
+// ascending score order. Ages are whole seconds as in the cache, so scores only
+// move on access or when the clock crosses a second; the heap is rebuilt lazily
+// on the first eviction of each new second instead of rescoring per miss.
+class ContentAwareSim : public SimPolicy {
+private:
+    const std::vector<float>& typePriorities;
+    IndexedMinHeap heap;
+    std::vector<uint32_t> residents;
+    std::vector<uint32_t> residentIndex;
+    std::vector<uint32_t> accessCount;
+    std::vector<int64_t> lastAccess;
+    std::vector<uint64_t> residentSize;
+    std::vector<uint16_t> residentType;
+    int64_t keysSecond;
+
+    HeapKey keyFor(uint32_t id, int64_t now) const {
+        uint16_t typeId = residentType[id];
+        float typePriority = typeId < typePriorities.size() ? typePriorities[typeId] : 0.5f;
+        float score = contentAwarePriorityScore(typePriority, residentSize[id], accessCount[id],
+                                                static_cast<float>(now - lastAccess[id]));
+        return {score, id};
+    }
+
+    void removeResident(uint32_t id) {
+        uint32_t index = residentIndex[id];
+        uint32_t last = residents.back();
+        residents[index] = last;
+        residentIndex[last] = index;
+        residents.pop_back();
+        residentIndex[id] = NIL;
+        used -= residentSize[id];
+    }
+
+public:
+    ContentAwareSim(uint64_t capacity, size_t objectCount, const std::vector<float>& typePriorities)
+        : SimPolicy(capacity), typePriorities(typePriorities), heap(objectCount),
+          residentIndex(objectCount, NIL), accessCount(objectCount, 0),
+          lastAccess(objectCount, 0), residentSize(objectCount, 0), residentType(objectCount, 0),
+          keysSecond(0) {}
+
+    const char* name() const override { return "content"; }
+
+    bool access(uint32_t id, uint64_t size, uint16_t typeId, float nowSeconds) override {
+        int64_t now = static_cast<int64_t>(nowSeconds);
+
+        if (residentIndex[id] != NIL) {
+            accessCount[id]++;
+            lastAccess[id] = now;
+            if (now == keysSecond) {
+                heap.set(id, keyFor(id, now));
+            }
+            return true;
+        }
+
+        if (used + size > capacity && !residents.empty()) {
+            if (now != keysSecond) {
+                for (uint32_t r : residents) {
+                    heap.assign(r, keyFor(r, now));
+                }
+                heap.heapify();
+                keysSecond = now;
+            }
+            while (used + size > capacity && !heap.empty()) {
+                removeResident(heap.popMin());
+            }
+        }
+
+        if (size <= capacity) {
+            residentIndex[id] = static_cast<uint32_t>(residents.size());
+            residents.push_back(id);
+            residentSize[id] = size;
+            residentType[id] = typeId;
+            accessCount[id] = 1;
+            lastAccess[id] = now;
+            used += size;
+            heap.set(id, keyFor(id, now));
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+// SimTrace implementation
+uint32_t SimTrace::addObject(const std::string& path, uint64_t size) {
+    auto it = objectIds.find(path);
+    if (it != objectIds.end()) {
+        sizes[it->second] = std::max(sizes[it->second], size);
+        return it->second;
+    }
+
+    // Typed exactly as the cache types it
+    std::string ext(FileTypeTable::extensionOf(path));
+    auto typeIt = typeIndex.find(ext);
+    if (typeIt == typeIndex.end()) {
+        typeIt = typeIndex.emplace(ext, static_cast<uint16_t>(typeNames.size())).first;
+        typeNames.push_back(ext);
+    }
+
+    uint32_t id = static_cast<uint32_t>(paths.size());
+    paths.push_back(path);
+    sizes.push_back(size);
+    typeIds.push_back(typeIt->second);
+    objectIds.emplace(path, id);
+    return id;
+}
+
+uint64_t SimTrace::getTotalObjectBytes() const {
+    uint64_t total = 0;
+    for (uint64_t size : sizes) {
+        total += size;
+    }
+    return total;
+}
+
+bool SimTrace::loadFromTraceFile(const std::string& tracePath, SimTrace& trace) {
+    TraceReader reader;
+    if (!reader.open(tracePath)) {
+        return false;
+    }
+
+    const auto& tracePaths = reader.getPaths();
+    std::vector<uint32_t> objectForPath(tracePaths.size(), NIL);
+
+    TraceRecord rec;
+    while (reader.next(rec)) {
+        if (rec.op != TraceOp::Open || rec.pathId >= tracePaths.size()) {
+            continue;
+        }
+        uint32_t& objectId = objectForPath[rec.pathId];
+        if (objectId == NIL) {
+            objectId = trace.addObject(tracePaths[rec.pathId], rec.length);
+        } else {
+            trace.sizes[objectId] = std::max<uint64_t>(trace.sizes[objectId], rec.length);
+        }
+        trace.accesses.push_back(objectId);
+        trace.accessTimes.push_back(static_cast<float>(rec.timestampNs / 1e9));
+    }
+
+    return true;
+}
+
+std::vector<std::string> simPolicyNames() {
+    return {"lru", "fifo", "lfu", "gdsf", "content"};
+}
+
+std::unique_ptr<SimPolicy> createSimPolicy(const std::string& name, uint64_t capacity, size_t objectCount,
+                                           const std::vector<float>& typePriorities) {
+    if (name == "lru") return std::unique_ptr<SimPolicy>(new ListSim(capacity, objectCount, true));
+    if (name == "fifo") return std::unique_ptr<SimPolicy>(new ListSim(capacity, objectCount, false));
+    if (name == "lfu") return std::unique_ptr<SimPolicy>(new HeapSim(capacity, objectCount, false));
+    if (name == "gdsf") return std::unique_ptr<SimPolicy>(new HeapSim(capacity, objectCount, true));
+    if (name == "content") return std::unique_ptr<SimPolicy>(new ContentAwareSim(capacity, objectCount, typePriorities));
+    return nullptr;
+}
+
+std::vector<float> resolveTypePriorities(const SimTrace& trace,
+                                         const std::unordered_map<std::string, float>& priorities) {
+    std::vector<float> resolved(trace.typeNames.size(), 0.5f);  // Default for unknown types
+    for (size_t i = 0; i < trace.typeNames.size(); i++) {
+        auto it = priorities.find(trace.typeNames[i]);
+        if (it != priorities.end()) {
+            resolved[i] = it->second;
+        }
+    }
+    return resolved;
+}
+
+SimResult runSimulation(const SimTrace& trace, const std::string& policy, uint64_t capacity,
+                        const std::vector<float>& typePriorities) {
+    SimResult result;
+    result.policy = policy;
+    result.capacity = capacity;
+
+    auto sim = createSimPolicy(policy, capacity, trace.paths.size(), typePriorities);
+    if (!sim) {
+        return result;
+    }
+
+    bool timed = trace.accessTimes.size() == trace.accesses.size();
+    for (size_t i = 0; i < trace.accesses.size(); i++) {
+        uint32_t id = trace.accesses[i];
+        uint64_t size = trace.sizes[id];
+        if (sim->access(id, size, trace.typeIds[id], timed ? trace.accessTimes[i] : 0.0f)) {
+            result.hits++;
+            result.bytesHit += size;
+        } else {
+            result.misses++;
+            result.bytesMissed += size;
+        }
+    }
+
+    return result;
+}
+
+std::vector<SimResult> runSimulationSweep(const SimTrace& trace, const std::vector<std::string>& policies,
+                                          const std::vector<uint64_t>& capacities,
+                                          const std::vector<float>& typePriorities, size_t jobs) {
+    std::vector<SimResult> results(policies.size() * capacities.size());
+    std::atomic<size_t> nextRun{0};
+
+    auto worker = [&]() {
+        for (size_t run = nextRun++; run < results.size(); run = nextRun++) {
+            const std::string& policy = policies[run / capacities.size()];
+            uint64_t capacity = capacities[run % capacities.size()];
+            results[run] = runSimulation(trace, policy, capacity, typePriorities);
+        }
+    };
+
+    jobs = std::max<size_t>(1, std::min(jobs, results.size()));
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < jobs; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    return results;
+}
@@ -0,0 +1,90 @@
+// cache_simulator.h
+#ifndef CACHE_SIMULATOR_H
+#define CACHE_SIMULATOR_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// Metadata-only workload: objects are described by (path, size, type) and
+// accesses are object ids. No payload bytes and no filesystem are involved.
+struct SimTrace {
+    std::vector<std::string> paths;
+    std::vector<uint64_t> sizes;
+    std::vector<uint16_t> typeIds;
+    std::vector<std::string> typeNames;
+    std::vector<uint32_t> accesses;
+    std::vector<float> accessTimes;  // Seconds since trace start; empty = all accesses at t=0
+
+    // Adds an object (or updates its size) and returns its id
+    uint32_t addObject(const std::string& path, uint64_t size);
+    uint64_t getTotalObjectBytes() const;
+
+    // Builds a trace from the opens recorded in an access trace file
+    static bool loadFromTraceFile(const std::string& tracePath, SimTrace& trace);
+
+private:
+    std::unordered_map<std::string, uint32_t> objectIds;
+    std::unordered_map<std::string, uint16_t> typeIndex;
+};
+
+// Outcome of one simulated run
+struct SimResult {
+    std::string policy;
+    uint64_t capacity = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t bytesHit = 0;
+    uint64_t bytesMissed = 0;
+
+    double hitRate() const {
+        uint64_t total = hits + misses;
+        return total ? static_cast<double>(hits) / total : 0.0;
+    }
+    double byteHitRate() const {
+        uint64_t total = bytesHit + bytesMissed;
+        return total ? static_cast<double>(bytesHit) / total : 0.0;
+    }
+};
+
+// Eviction policy under simulation. Objects larger than the capacity are never admitted.
+class SimPolicy {
+protected:
+    uint64_t capacity;
+    uint64_t used;
+
+public:
+    explicit SimPolicy(uint64_t capacity) : capacity(capacity), used(0) {}
+    virtual ~SimPolicy() = default;
+
+    virtual const char* name() const = 0;
+
+    // Returns true on hit
+    virtual bool access(uint32_t objectId, uint64_t size, uint16_t typeId, float now) = 0;
+
+    uint64_t getUsedBytes() const { return used; }
+};
+
+// Policy names accepted by createSimPolicy()
+std::vector<std::string> simPolicyNames();
+
+// Creates "lru", "fifo", "lfu", "gdsf" or "content". typePriorities is indexed by
+// SimTrace::typeIds and is only used by the content-aware policy.
+std::unique_ptr<SimPolicy> createSimPolicy(const std::string& name, uint64_t capacity, size_t objectCount,
+                                           const std::vector<float>& typePriorities);
+
+// Resolves per-type priorities for a trace from an extension->priority table (unknown types get 0.5)
+std::vector<float> resolveTypePriorities(const SimTrace& trace,
+                                         const std::unordered_map<std::string, float>& priorities);
+
+SimResult runSimulation(const SimTrace& trace, const std::string& policy, uint64_t capacity,
+                        const std::vector<float>& typePriorities);
+
+// Runs every (policy, capacity) pair, spread over the given number of worker threads
+std::vector<SimResult> runSimulationSweep(const SimTrace& trace, const std::vector<std::string>& policies,
+                                          const std::vector<uint64_t>& capacities,
+                                          const std::vector<float>& typePriorities, size_t jobs);
+
+#endif // CACHE_SIMULATOR_H
@@ -0,0 +1,47 @@
+// coarse_clock.h
+#ifndef COARSE_CLOCK_H
+#define COARSE_CLOCK_H
+
+#include <cstdint>
+#include <chrono>
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+// Cheap monotonic clock for access timestamps.
+//
+// Time is counted in 32-bit ticks of 1/64 s, which is about the resolution of
+// CLOCK_MONOTONIC_COARSE and wraps after ~2 years. Compare ticks only through
+// elapsed(), which stays correct across the wrap.
+class CoarseClock {
+public:
+    static constexpr uint32_t TICKS_PER_SECOND = 64;
+
+    static uint32_t now() {
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+        // Served from the vDSO without a syscall; a few loads of the kernel's last tick
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return static_cast<uint32_t>(static_cast<uint64_t>(ts.tv_sec) * TICKS_PER_SECOND +
+                                     static_cast<uint64_t>(ts.tv_nsec) / (1000000000 / TICKS_PER_SECOND));
+#else
+        auto sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch).count() /
+            (1000000000 / TICKS_PER_SECOND));
+#endif
+    }
+
+    // Ticks from earlier to later; 0 if earlier is actually the later of the two
+    static uint32_t elapsed(uint32_t earlier, uint32_t later) {
+        int32_t delta = static_cast<int32_t>(later - earlier);
+        return delta > 0 ? static_cast<uint32_t>(delta) : 0;
+    }
+
+    // Whole seconds from earlier to later
+    static uint32_t elapsedSeconds(uint32_t earlier, uint32_t later) {
+        return elapsed(earlier, later) / TICKS_PER_SECOND;
+    }
+};
+
+#endif // COARSE_CLOCK_H
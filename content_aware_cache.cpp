@@ -1,36 +1,362 @@
 // content_aware_cache.cpp
 #include "content_aware_cache.h"
+#include "access_trace.h"
+#include "mrc_estimator.h"
+#include "access_buffer.h"
+#include "hot_replicas.h"
+#include "numa_topology.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <random>
+#include <thread>
+
+// An entry's version pinned for write-back the way an open handle pins it
+struct WriteBackPin {
+    std::shared_ptr<CacheEntry> entry;
+    std::shared_ptr<CachePayload> version;  // entry->latest at the time, if any
+    const CachePayload* contents;
+};
+
+namespace {
+
+// Distinguishes caches in the per-thread access buffer lookup
+std::atomic<uint64_t> nextCacheId{1};
+
+// Entries written per write-back task, so a large flush spreads over the pool
+constexpr size_t WRITE_BACK_BATCH = 64;
+
+// Pinned writes go to disk in pieces of this size, each admitted on its own,
+// so demand I/O can get in between the pieces of a large file
+constexpr size_t WRITE_BACK_CHUNK = 1024 * 1024;
+
+// Revalidation windows are kept in CoarseClock ticks, rounded up, and capped
+// so maxAge plus the stale window still fits the tick arithmetic
+uint32_t ticksFor(std::chrono::milliseconds duration) {
+    if (duration.count() <= 0) {
+        return 0;
+    }
+    uint64_t ticks = (static_cast<uint64_t>(duration.count()) * CoarseClock::TICKS_PER_SECOND + 999) / 1000;
+    return static_cast<uint32_t>(std::min<uint64_t>(ticks, INT32_MAX / 2));
+}
+
+// True if the file on disk is still the one the stamp was taken from
+bool sourceUnchanged(const SourceStamp& stamp, const FileMetadata& metadata) {
+    return stamp.known && metadata.fileSize == stamp.size && metadata.lastModified == stamp.modified;
+}
+
+// Access buffer used by this thread for the cache it last closed a file of
+thread_local uint64_t cachedBufferCacheId = 0;
+thread_local AccessBuffer* cachedBuffer = nullptr;
+
+// Hot replicas of this thread for the cache it last opened a file of for reading
+thread_local uint64_t cachedReplicaSetCacheId = 0;
+thread_local HotReplicaSet* cachedReplicaSet = nullptr;
+
+// Replica sets this thread owns, marked orphaned when it exits so caches that
+// are still alive can release the entries they pin
+struct ReplicaSetOwnership {
+    std::vector<std::pair<std::weak_ptr<ContentAwareCache>, HotReplicaSet*>> sets;
+    
+    ~ReplicaSetOwnership() {
+        for (auto& owned : sets) {
+            // A live cache keeps its sets alive
+            if (auto cache = owned.first.lock()) {
+                owned.second->orphaned.store(true, std::memory_order_release);
+            }
+        }
+    }
+};
+
+thread_local ReplicaSetOwnership replicaSetOwnership;
+
+// TraceModeBits for the fopen mode that produced the given flags
+uint8_t traceModeFromFlags(uint8_t modeFlags) {
+    uint8_t bits = 0;
+    bool plus = false;
+    if (modeFlags & MODE_APPEND) {
+        bits = TRACE_MODE_APPEND;
+        plus = (modeFlags & MODE_READ) != 0;
+    } else if (modeFlags & MODE_TRUNCATE) {
+        bits = TRACE_MODE_WRITE;
+        plus = (modeFlags & MODE_READ) != 0;
+    } else {
+        bits = TRACE_MODE_READ;
+        plus = (modeFlags & MODE_WRITE) != 0;
+    }
+    if (plus) bits |= TRACE_MODE_PLUS;
+    if (modeFlags & MODE_EXCLUSIVE) bits |= TRACE_MODE_EXCLUSIVE;
+    if (modeFlags & MODE_BINARY) bits |= TRACE_MODE_BINARY;
+    return bits;
+}
+
+// Entry with room for N payload bytes in the same allocation
+template <size_t N>
+class InlineCacheEntry : public CacheEntry {
+private:
+    char inlineBytes[N];
+    
+public:
+    InlineCacheEntry(const std::string& filePath, FileTypeId typeId, size_t fileSize)
+        : CacheEntry(filePath, typeId, fileSize) {
+        data.useInlineStorage(inlineBytes, N);
+    }
+};
+
+// Writes contents to a new file beside path and renames it over path, so
+// readers and a crash never see the file half written. Each piece of at most
+// chunk bytes is admitted by the scheduler (when there is one) on its own.
+bool writeReplacing(const std::string& path, const CachePayload& contents, IoScheduler* scheduler,
+                    IoClass ioClass, size_t chunk) {
+    static const uint64_t processTag = std::random_device()();
+    static std::atomic<uint64_t> nextTemp{0};
+    std::string temp = path + ".cache-" + std::to_string(processTag) + "-" + std::to_string(nextTemp++);
+    
+    std::ofstream file(temp, std::ios::binary);
+    size_t size = contents.size();
+    for (size_t offset = 0; file && offset < size; offset += chunk) {
+        size_t length = std::min(chunk, size - offset);
+        IoScheduler::Ticket ticket;
+        if (scheduler) {
+            ticket = scheduler->acquire(ioClass, length);
+        }
+        file.write(contents.data() + offset, length);
+        file.flush();
+    }
+    file.close();
+    
+    std::error_code error;
+    if (file) {
+        // The replacement keeps the original's permissions
+        fs::file_status original = fs::status(path, error);
+        if (!error) {
+            fs::permissions(temp, original.permissions(), error);
+        }
+        fs::rename(temp, path, error);
+        if (!error) {
+            return true;
+        }
+    }
+    fs::remove(temp, error);
+    return false;
+}
+
+// Fills the empty payload out with base followed by tail
+void appendTail(CachePayload& out, const CachePayload& base, const CachePayload& tail, PayloadArena* arena) {
+    out.resizeUninitialized(base.size() + tail.size(), arena, nullptr);
+    if (!base.empty()) {
+        std::memcpy(out.data(), base.data(), base.size());
+    }
+    if (!tail.empty()) {
+        std::memcpy(out.data() + base.size(), tail.data(), tail.size());
+    }
+}
+
+} // namespace
+
+// CachePayload implementation
+void CachePayload::releaseStorage() {
+    if (storage == STORAGE_HEAP) {
+        std::free(bytes);
+    } else if (storage == STORAGE_ARENA) {
+        PayloadArena::free(bytes);
+    }
+}
+
+void CachePayload::useInlineStorage(char* inlineBytes, size_t inlineCapacity) {
+    releaseStorage();
+    bytes = inlineBytes;
+    capacity = inlineCapacity;
+    storage = STORAGE_INLINE;
+}
+
+void CachePayload::resize(size_t newSize, PayloadArena* arena, CacheEntry* owner) {
+    size_t oldSize = length;
+    resizeUninitialized(newSize, arena, owner);
+    if (newSize > oldSize) {
+        std::memset(bytes + oldSize, 0, newSize - oldSize);
+    }
+}
+
+void CachePayload::resizeUninitialized(size_t newSize, PayloadArena* arena, CacheEntry* owner) {
+    if (newSize > capacity) {
+        // Grow geometrically so repeated appends stay amortized O(1), but not
+        // past the arena's block limit for a payload that still fits a block
+        size_t newCapacity = std::max(newSize, static_cast<size_t>(length) * 2);
+        if (newSize <= PayloadArena::MAX_BLOCK) {
+            newCapacity = std::min(newCapacity, PayloadArena::MAX_BLOCK);
+        }
+        reserve(newCapacity, arena, owner);
+    }
+    length = newSize;
+}
+
+void CachePayload::reserve(size_t minCapacity, PayloadArena* arena, CacheEntry* owner) {
+    if (minCapacity > capacity) {
+        size_t newCapacity = std::min(MAX_SIZE, minCapacity);
+        char* newBytes;
+        uint64_t newStorage;
+        
+        if (arena && newCapacity <= PayloadArena::MAX_BLOCK) {
+            newBytes = arena->allocate(owner, newCapacity, newCapacity);
+            newStorage = STORAGE_ARENA;
+        } else if (arena && (newBytes = arena->allocateLarge(newCapacity, newCapacity))) {
+            // Huge-page region, when the cache reserved one and it has room
+            newCapacity = std::min(newCapacity, MAX_SIZE);
+            newStorage = STORAGE_ARENA;
+        } else {
+            newBytes = static_cast<char*>(std::malloc(newCapacity));
+            if (!newBytes) {
+                throw std::bad_alloc();
+            }
+            newStorage = STORAGE_HEAP;
+        }
+        
+        if (length > 0) {
+            std::memcpy(newBytes, bytes, length);
+        }
+        releaseStorage();
+        bytes = newBytes;
+        capacity = newCapacity;
+        storage = newStorage;
+    }
+}
+
+void CachePayload::adopt(CachePayload& other) {
+    releaseStorage();
+    bytes = other.bytes;
+    length = other.length;
+    capacity = other.capacity;
+    storage = other.storage;
+    other.bytes = nullptr;
+    other.length = 0;
+    other.capacity = 0;
+    other.storage = STORAGE_NONE;
+}
+
+// CacheEntry implementation
+std::shared_ptr<CacheEntry> CacheEntry::create(const std::string& filePath, FileTypeId typeId,
+                                               size_t expectedSize) {
+    // Size classes chosen so entry + control block fill whole 64-byte lines
+    if (expectedSize <= 8) {
+        return std::make_shared<InlineCacheEntry<8>>(filePath, typeId, expectedSize);
+    } else if (expectedSize <= 72) {
+        return std::make_shared<InlineCacheEntry<72>>(filePath, typeId, expectedSize);
+    } else if (expectedSize <= 136) {
+        return std::make_shared<InlineCacheEntry<136>>(filePath, typeId, expectedSize);
+    } else if (expectedSize <= MAX_INLINE_PAYLOAD) {
+        return std::make_shared<InlineCacheEntry<MAX_INLINE_PAYLOAD>>(filePath, typeId, expectedSize);
+    }
+    return std::make_shared<CacheEntry>(filePath, typeId, expectedSize);
+}
 
 // CacheFile implementation
+CacheFile::CacheFile(CacheFile&& other) noexcept
+    : entry(std::move(other.entry)), snapshot(other.snapshot), pinned(std::move(other.pinned)),
+      draft(std::move(other.draft)), draftBase(other.draftBase), heldBytes(other.heldBytes),
+      position(other.position), modeFlags(other.modeFlags), modified(other.modified), cacheHit(other.cacheHit),
+      countsAccess(other.countsAccess), cachePtr(std::move(other.cachePtr)), reservedBytes(other.reservedBytes), trace(std::move(other.trace)),
+      tracePathId(other.tracePathId) {
+    other.heldBytes = 0;
+    other.modeFlags = 0;
+    other.modified = false;
+    other.reservedBytes = 0;
+}
+
+CacheFile& CacheFile::operator=(CacheFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        entry = std::move(other.entry);
+        snapshot = other.snapshot;
+        pinned = std::move(other.pinned);
+        draft = std::move(other.draft);
+        draftBase = other.draftBase;
+        heldBytes = other.heldBytes;
+        position = other.position;
+        modeFlags = other.modeFlags;
+        modified = other.modified;
+        cacheHit = other.cacheHit;
+        countsAccess = other.countsAccess;
+        cachePtr = std::move(other.cachePtr);
+        reservedBytes = other.reservedBytes;
+        trace = std::move(other.trace);
+        tracePathId = other.tracePathId;
+        other.heldBytes = 0;
+        other.modeFlags = 0;
+        other.modified = false;
+        other.reservedBytes = 0;
+    }
+    return *this;
+}
+
 CacheFile::~CacheFile() {
+    close();
+}
+
+void CacheFile::close() {
+    if (!entry) {
+        return;
+    }
+    
     // Flush changes if needed
     if (modified) {
         flush();
     }
     
-    // Update access stats
+    if (trace) {
+        trace->record(TraceOp::Close, tracePathId, position, 0);
+        trace.reset();
+    }
+    
+    releaseReservation();
+    
+    // Unpin before the close is queued; the entry may fold latest into data once it is applied
+    draft.reset();
+    pinned.reset();
+    snapshot = nullptr;
+    
+    // Access stats are applied later by whichever thread next holds cacheMutex
+    if (auto cache = cachePtr.lock()) {
+        cache->recordAccess(std::move(entry), countsAccess);
+    }
+    
+    entry.reset();
+    cachePtr.reset();
+    modeFlags = 0;
+}
+
+void CacheFile::releaseReservation() {
+    if (reservedBytes == 0 && heldBytes == 0) {
+        return;
+    }
     if (auto cache = cachePtr.lock()) {
         std::lock_guard<std::mutex> lock(cache->cacheMutex);
-        entry->stats.accessCount++;
-        entry->stats.lastAccessed = std::chrono::system_clock::now();
-        cache->updateEntryScore(entry->metadata.filePath);
+        cache->currentCacheSize -= std::min(reservedBytes, cache->currentCacheSize);
+        cache->zombieBytes -= std::min(heldBytes, cache->zombieBytes);
     }
+    reservedBytes = 0;
+    heldBytes = 0;
 }
 
 size_t CacheFile::read(void* buffer, size_t size, size_t count) {
-    if (mode.find('r') == std::string::npos) {
-        // Not opened for reading
+    if (!(modeFlags & MODE_READ)) {
+        // Not opened for reading (or closed)
         return 0;
     }
     
     size_t bytesToRead = size * count;
-    size_t bytesAvailable = entry->data.size() - position;
+    if (trace) {
+        trace->record(TraceOp::Read, tracePathId, position, bytesToRead);
+    }
+    
+    const CachePayload& data = contents();
+    size_t bytesAvailable = data.size() - position;
     size_t bytesToCopy = std::min(bytesToRead, bytesAvailable);
     
     if (bytesToCopy > 0) {
-        std::memcpy(buffer, entry->data.data() + position, bytesToCopy);
+        std::memcpy(buffer, data.data() + position, bytesToCopy);
         position += bytesToCopy;
     }
     
@@ -38,36 +364,61 @@ size_t CacheFile::read(void* buffer, size_t size, size_t count) {
 }
 
 size_t CacheFile::write(const void* buffer, size_t size, size_t count) {
-    if (mode.find('w') == std::string::npos && mode.find('a') == std::string::npos) {
-        // Not opened for writing
+    if (!(modeFlags & MODE_WRITE)) {
+        // Not opened for writing (or closed)
         return 0;
     }
     
     size_t bytesToWrite = size * count;
+    CachePayload& data = beginWrite();
+    size_t offset = draftOffset();
     
     // If appending, move to the end
-    if (mode.find('a') != std::string::npos && position != entry->data.size()) {
-        position = entry->data.size();
+    if ((modeFlags & MODE_APPEND) && position != offset + data.size()) {
+        position = offset + data.size();
+    }
+    
+    if (trace) {
+        trace->record(TraceOp::Write, tracePathId, position, bytesToWrite);
+    }
+    
+    if (position + bytesToWrite > CachePayload::MAX_SIZE) {
+        return 0;
     }
     
     // Check if we need to resize the buffer
-    if (position + bytesToWrite > entry->data.size()) {
-        // Get the cache to ensure we have space
-        if (auto cache = cachePtr.lock()) {
-            // Request additional space
-            size_t oldSize = entry->data.size();
-            size_t newSize = position + bytesToWrite;
-            size_t additionalSpace = newSize - oldSize;
-            
+    // (seek() never passes the end, so the copy below covers all new bytes)
+    if (position + bytesToWrite > offset + data.size()) {
+        size_t oldSize = data.size();
+        size_t newSize = position - offset + bytesToWrite;
+        size_t growth = newSize - oldSize;
+        
+        if (growth <= reservedBytes && newSize <= data.getCapacity()) {
+            // Budget and capacity were reserved by an earlier write
+            data.resizeUninitialized(newSize);
+            reservedBytes -= growth;
+        } else if (auto cache = cachePtr.lock()) {
             std::lock_guard<std::mutex> lock(cache->cacheMutex);
-            cache->makeRoomInCache(additionalSpace);
-            entry->data.resize(newSize);
-            cache->currentCacheSize += additionalSpace;
+            
+            // Reserve the growth plus headroom for the writes likely to follow
+            size_t headroom = std::min({std::max(newSize, MIN_WRITE_RESERVE), MAX_WRITE_RESERVE,
+                                        cache->maxCacheSize / 16, CachePayload::MAX_SIZE - newSize});
+            size_t charge = growth - std::min(growth, reservedBytes) + headroom;
+            cache->makeRoomInCache(charge);
+            cache->currentCacheSize += charge;
+            reservedBytes = reservedBytes + charge - growth;
+            
+            // Drafts have no owner entry, so compaction leaves their blocks in place
+            data.reserve(newSize + reservedBytes, cache->payloadArena.get(), nullptr);
+            data.resizeUninitialized(newSize);
+        } else {
+            // Cache is gone; the draft is only ours now
+            data.resizeUninitialized(newSize);
         }
     }
     
     // Copy the data
-    std::memcpy(entry->data.data() + position, buffer, bytesToWrite);
+    std::memcpy(data.data() + (position - offset), buffer, bytesToWrite);
     position += bytesToWrite;
     modified = true;
     
@@ -75,6 +426,10 @@ size_t CacheFile::write(const void* buffer, size_t size, size_t count) {
 }
 
 int CacheFile::seek(long offset, int origin) {
+    if (!entry) {
+        return -1;
+    }
+    
     size_t newPosition;
     
     switch (origin) {
@@ -85,13 +440,13 @@ int CacheFile::seek(long offset, int origin) {
             newPosition = position + offset;
             break;
         case SEEK_END:
-            newPosition = entry->data.size() + offset;
+            newPosition = contentsSize() + offset;
             break;
         default:
             return -1;
     }
     
-    if (newPosition > entry->data.size()) {
+    if (newPosition > contentsSize()) {
         // Cannot seek beyond end of file
         return -1;
     }
@@ -104,25 +459,88 @@ long CacheFile::tell() {
     return static_cast<long>(position);
 }
 
+CachePayload& CacheFile::beginWrite() {
+    if (!draft) {
+        // Copy on first write; the published version is never modified.
+        // Appends start from an empty tail instead.
+        const CachePayload& base = *snapshot;
+        size_t copied = appendsTail() ? 0 : base.size();
+        draft.reset(new CachePayload());
+        draftBase = base.size();
+        
+        auto cache = copied > 0 ? cachePtr.lock() : nullptr;
+        if (cache) {
+            // The copy is charged before it is made, like any other load
+            std::lock_guard<std::mutex> lock(cache->cacheMutex);
+            cache->makeRoomInCache(copied);
+            cache->zombieBytes += copied;
+            heldBytes = copied;
+            draft->reserve(copied, cache->payloadArena.get(), nullptr);
+        }
+        
+        // Our handle keeps the base in place, so it is copied without the lock
+        draft->resizeUninitialized(copied);
+        if (copied > 0) {
+            std::memcpy(draft->data(), base.data(), copied);
+        }
+    }
+    return *draft;
+}
+
 int CacheFile::flush() {
-    if (!modified) {
+    if (!modified || !entry) {
         return 0;
     }
     
-    // Write back to disk
-    std::ofstream file(entry->metadata.filePath, std::ios::binary);
-    if (!file) {
-        return -1;
+    auto cache = cachePtr.lock();
+    uint64_t pathHash = hashPath(entry->filePath);
+    if (cache) {
+        // Writes of one path reach the disk in the order they are published
+        std::unique_lock<std::mutex> lock(cache->cacheMutex);
+        cache->loadFinished.wait(lock, [&] { return !cache->isLoading(entry->filePath, pathHash); });
+        
+        // New readers see the writes from here on; the draft becomes our snapshot.
+        // Without the cache nobody else can open the entry, so the draft just stays.
+        if (draft) {
+            cache->publishDraft(*this);
+        }
+        // A miss on the path waits for the new file instead of reading the old one
+        cache->pendingLoads.emplace_back(pathHash, entry->filePath);
+    } else if (draft && appendsTail()) {
+        // An appended tail is only written out together with its base
+        auto version = std::make_shared<CachePayload>();
+        appendTail(*version, *snapshot, *draft, nullptr);
+        pinned = std::move(version);
+        snapshot = pinned.get();
+        draft.reset();
     }
     
-    file.write(entry->data.data(), entry->data.size());
-    if (!file) {
-        return -1;
-    }
+    // Write back to disk, in one piece; the ticket is released before cacheMutex is taken
+    const CachePayload& data = contents();
+    bool written = writeReplacing(entry->filePath, data, cache ? &cache->ioScheduler : nullptr,
+                                  IoClass::Demand, std::max<size_t>(data.size(), 1));
     
-    if (auto cache = cachePtr.lock()) {
+    if (cache) {
+        // Stat'ed while the path is still ours, before taking the lock
+        FileMetadata metadata;
+        if (written) {
+            metadata = cache->getFileMetadata(entry->filePath);
+        }
         std::lock_guard<std::mutex> lock(cache->cacheMutex);
-        cache->diskWrites++;
+        cache->finishLoad(pathHash, entry->filePath);
+        if (written) {
+            cache->diskWrites++;
+            cache->noteWritten(*entry, metadata);
+            if (snapshot == &entry->current()) {
+                entry->dirty = false;
+            }
+        } else {
+            // Left for the next flush of the cache
+            entry->dirty = true;
+        }
+    }
+    if (!written) {
+        return -1;
     }
     
     modified = false;
@@ -131,33 +549,43 @@ int CacheFile::flush() {
 
 // ContentAwareCache implementation
 ContentAwareCache::ContentAwareCache(size_t maxSize) 
-    : maxCacheSize(maxSize), currentCacheSize(0),
-      cacheHits(0), cacheMisses(0), diskReads(0), diskWrites(0) {
-    
-    // Setup default file type priorities
-    fileTypePriorities = {
-        {".txt", 0.7f},
-        {".cfg", 0.9f},
-        {".conf", 0.9f},
-        {".ini", 0.9f},
-        {".log", 0.6f},
-        {".json", 0.8f},
-        {".xml", 0.8f},
-        {".cpp", 0.7f},
-        {".h", 0.7f},
-        {".c", 0.7f},
-        {".py", 0.7f},
-        {".jpg", 0.4f},
-        {".png", 0.4f},
-        {".pdf", 0.3f},
-        {".exe", 0.1f},
-        {".so", 0.1f},
-        {".dll", 0.1f}
-    };
+    : payloadArena(new PayloadArena()), maxCacheSize(maxSize), currentCacheSize(0), zombieBytes(0),
+      cacheHits(0), cacheMisses(0), diskReads(0), diskWrites(0), staleHits(0), backgroundRefreshes(0),
+      blockingRevalidations(0), numaReplication(false),
+      replicaEpoch(0), cacheId(nextCacheId++), accessBuffers(nullptr), replicaSets(nullptr),
+      executorStopped(false) {
+    // fileTypes starts out with the built-in types and their default priorities
 }
 
 ContentAwareCache::~ContentAwareCache() {
+    // Background tasks use the cache, so they finish while it is whole. Tasks
+    // still running see no pool and fall back to working inline.
+    std::unique_ptr<CacheExecutor> pool;
+    {
+        std::lock_guard<std::mutex> lock(executorMutex);
+        executorStopped = true;
+        pool = std::move(executor);
+    }
+    if (pool) {
+        pool->shutdown();
+    }
+    
     flush();
+    
+    // Replica views close without queueing accesses, as the cache is gone
+    HotReplicaSet* replicas = replicaSets.load(std::memory_order_acquire);
+    while (replicas) {
+        HotReplicaSet* next = replicas->next;
+        delete replicas;
+        replicas = next;
+    }
+    
+    AccessBuffer* buffer = accessBuffers.load(std::memory_order_acquire);
+    while (buffer) {
+        AccessBuffer* next = buffer->next;
+        delete buffer;
+        buffer = next;
+    }
 }
 
 FileMetadata ContentAwareCache::getFileMetadata(const std::string& filePath) {
@@ -179,147 +607,428 @@ metadata.lastModified = fs::last_write_time(path);
     return metadata;
 }
 
-float ContentAwareCache::calculatePriorityScore(const std::shared_ptr<CacheEntry>& entry) {
-    // Higher score = higher priority to keep in cache
-    float score = 0.0f;
-    
-    // Factor 1: File type priority (0.0-1.0)
-    float typePriority = 0.5f;  // Default for unknown types
-    auto it = fileTypePriorities.find(entry->metadata.fileType);
-    if (it != fileTypePriorities.end()) {
-        typePriority = it->second;
-    }
-    
+float contentAwarePriorityScore(float typePriority, size_t fileSize, size_t accessCount,
+                                float secondsSinceAccess) {
     // Factor 2: File size (favor smaller files)
     // 1.0 for files < 1KB, decreasing for larger files
     float sizeScore = 1.0f;
-    if (entry->metadata.fileSize > 1024) {
-        sizeScore = std::min(1.0f, 10240.0f / static_cast<float>(entry->metadata.fileSize));
+    if (fileSize > 1024) {
+        sizeScore = std::min(1.0f, 10240.0f / static_cast<float>(fileSize));
     }
     
     // Factor 3: Access frequency 
     // Log scale: more accesses = higher score
-    float accessScore = 0.1f + std::min(0.9f, std::log2(1.0f + entry->stats.accessCount) / 10.0f);
+    float accessScore = 0.1f + std::min(0.9f, std::log2(1.0f + accessCount) / 10.0f);
     
     // Factor 4: Recency of access
     // Score decreases as time since last access increases
-    auto now = std::chrono::system_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::seconds>(
-        now - entry->stats.lastAccessed).count();
-    float recencyScore = std::exp(-duration / 3600.0f); // Decay over ~1 hour
+    float recencyScore = std::exp(-secondsSinceAccess / 3600.0f); // Decay over ~1 hour
     
     // Combine factors with weights
-    score = (typePriority * 0.3f) + (sizeScore * 0.2f) + 
-            (accessScore * 0.3f) + (recencyScore * 0.2f);
+    return (typePriority * 0.3f) + (sizeScore * 0.2f) + 
+           (accessScore * 0.3f) + (recencyScore * 0.2f);
+}
+
+float ContentAwareCache::calculatePriorityScore(const std::shared_ptr<CacheEntry>& entry) {
+    return calculatePriorityScore(*entry, CoarseClock::now());
+}
+
+float contentAwarePriorityScore(const FileTypeTable& types, const CacheEntry& entry, uint32_t nowTick) {
+    // Higher score = higher priority to keep in cache
+    
+    // Factor 1: File type priority (0.0-1.0, 0.5 for unknown types)
+    float typePriority = types.getPriority(entry.typeId);
+    
+    uint32_t seconds = CoarseClock::elapsedSeconds(entry.stats.lastAccessTick, nowTick);
     
-    return score;
+    return contentAwarePriorityScore(typePriority, entry.fileSize,
+                                     entry.stats.accessCount, static_cast<float>(seconds));
 }
 
-void ContentAwareCache::updateLRU(const std::string& filePath) {
-    auto it = lruMap.find(filePath);
+float ContentAwareCache::calculatePriorityScore(const CacheEntry& entry, uint32_t nowTick) {
+    return contentAwarePriorityScore(fileTypes, entry, nowTick);
+}
+
+void ContentAwareCache::updateLRU(IndexedEntry& indexed) {
+    // Move to front of LRU list, reusing the node
+    lruList.splice(lruList.begin(), lruList, indexed.lruPosition);
+}
+
+void ContentAwareCache::insertEntry(const std::shared_ptr<CacheEntry>& entry, uint64_t pathHash) {
+    lruList.push_front(entry.get());
+    cacheIndex.insert(pathHash, IndexedEntry{entry, lruList.begin()});
     
-    if (it != lruMap.end()) {
-        // Move to front of LRU list
-        lruList.erase(it->second);
+    if (entry->typeId >= entriesByType.size()) {
+        entriesByType.resize(entry->typeId + 1);
     }
+    std::vector<CacheEntry*>& sameType = entriesByType[entry->typeId];
+    entry->typePosition = static_cast<uint32_t>(sameType.size());
+    sameType.push_back(entry.get());
+    if (hasRevalidation(entry->typeId)) {
+        // Unknown until the caller stamps it with the file it read
+        sourceStamps[entry->typeId].emplace_back();
+    }
+}
+
+const CacheEntry* selectEvictionVictim(const FlatPathIndex<IndexedEntry>& index) {
+    const CacheEntry* candidate = nullptr;
+    const CacheEntry* pinnedCandidate = nullptr;
+    float lowestScore = std::numeric_limits<float>::max();
+    float lowestPinnedScore = std::numeric_limits<float>::max();
     
-    lruList.push_front(filePath);
-    lruMap[filePath] = lruList.begin();
+    index.forEach([&](const IndexedEntry& indexed) {
+        const CacheEntry& entry = *indexed.entry;
+        if (entry.openHandles == 0) {
+            if (entry.priorityScore < lowestScore) {
+                lowestScore = entry.priorityScore;
+                candidate = &entry;
+            }
+        } else if (entry.priorityScore < lowestPinnedScore) {
+            lowestPinnedScore = entry.priorityScore;
+            pinnedCandidate = &entry;
+        }
+    });
+    
+    return candidate ? candidate : pinnedCandidate;
 }
 
 std::string ContentAwareCache::findEntryForEviction() {
-    if (cacheMap.empty()) {
+    if (cacheIndex.empty()) {
         return "";
     }
     
     // Find entry with lowest priority score
-    std::string candidatePath = "";
-    float lowestScore = std::numeric_limits<float>::max();
-    
-    for (const auto& pair : cacheMap) {
-        if (pair.second->priorityScore < lowestScore) {
-            lowestScore = pair.second->priorityScore;
-            candidatePath = pair.first;
-        }
-    }
+    const CacheEntry* victim = selectEvictionVictim(cacheIndex);
+    std::string candidatePath = victim ? victim->filePath : "";
     
     // Fallback to LRU if all scores are the same
     if (candidatePath.empty() && !lruList.empty()) {
-        candidatePath = lruList.back();
+        candidatePath = lruList.back()->filePath;
     }
     
     return candidatePath;
 }
 
-bool ContentAwareCache::loadFileIntoCache(const std::string& filePath) {
+std::shared_ptr<CacheEntry> ContentAwareCache::loadFileIntoCache(const std::string& filePath, uint64_t pathHash,
+                                                                std::unique_lock<std::mutex>& lock) {
+    // An empty file loads as an empty entry; one that is gone fails the read
     FileMetadata metadata = getFileMetadata(filePath);
-    if (metadata.fileSize == 0) {
-        return false;
+    if (metadata.fileSize > CachePayload::MAX_SIZE) {
+        return nullptr;
     }
     
-    // Make room in cache if needed
-    makeRoomInCache(metadata.fileSize);
+    // Read without the lock, so hits carry on while the read waits for its
+    // I/O ticket. Other opens of the path wait for this load instead of
+    // reading the file again (see openLocked).
+    pendingLoads.emplace_back(pathHash, filePath);
+    lock.unlock();
+    CachePayload staged;
+    bool read = false;
+    try {
+        read = readStaged(metadata, staged, IoClass::Demand);
+    } catch (...) {
+        lock.lock();
+        finishLoad(pathHash, filePath);
+        throw;
+    }
+    lock.lock();
+    finishLoad(pathHash, filePath);
+    if (!read) {
+        return nullptr;
+    }
+    
+    if (auto* slot = cacheIndex.find(filePath, pathHash)) {
+        return slot->value.entry;  // inserted or prefetched meanwhile
+    }
+    return installStaged(metadata, pathHash, staged);
+}
+
+bool ContentAwareCache::isLoading(std::string_view filePath, uint64_t pathHash) const {
+    for (const auto& load : pendingLoads) {
+        if (load.first == pathHash && load.second == filePath) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ContentAwareCache::finishLoad(uint64_t pathHash, const std::string& filePath) {
+    for (auto it = pendingLoads.begin(); it != pendingLoads.end(); ++it) {
+        if (it->first == pathHash && it->second == filePath) {
+            pendingLoads.erase(it);
+            break;
+        }
+    }
+    loadFinished.notify_all();
+}
+
+bool ContentAwareCache::readStaged(const FileMetadata& metadata, CachePayload& staged, IoClass ioClass) {
+    // Large contents go straight to their final storage (the huge-page region
+    // or the heap, neither of which compaction touches); small ones are staged
+    // and copied into the arena by installStaged()
+    bool large = metadata.fileSize > PayloadArena::MAX_BLOCK;
+    staged.resizeUninitialized(metadata.fileSize, large ? payloadArena.get() : nullptr);
+    return readFileContents(metadata.filePath, staged.data(), metadata.fileSize, ioClass);
+}
+
+bool ContentAwareCache::readFileContents(const std::string& filePath, char* destination, size_t size,
+                                         IoClass ioClass) {
+    IoScheduler::Ticket ticket = ioScheduler.acquire(ioClass, size);
     
-    // Read file into memory
     std::ifstream file(filePath, std::ios::binary);
     if (!file) {
         return false;
     }
-    
-    auto entry = std::make_shared<CacheEntry>(metadata);
-    entry->data.resize(metadata.fileSize);
-    
-    file.read(entry->data.data(), metadata.fileSize);
+    file.read(destination, size);
     if (!file && !file.eof()) {
         return false;
     }
+    if (static_cast<size_t>(file.gcount()) < size) {
+        // File shrank since it was sized; don't expose uninitialized bytes
+        std::memset(destination + file.gcount(), 0, size - file.gcount());
+    }
+    return true;
+}
+
+void ContentAwareCache::prefetchFile(const std::string& filePath, uint64_t pathHash) {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (cacheIndex.find(filePath, pathHash)) {
+            return;
+        }
+    }
+    
+    FileMetadata metadata = getFileMetadata(filePath);
+    if (metadata.fileSize == 0 || metadata.fileSize > CachePayload::MAX_SIZE) {
+        return;
+    }
+    
+    // Read without the lock, since prefetch I/O may be held back for a while
+    CachePayload staged;
+    if (!readStaged(metadata, staged, IoClass::Prefetch)) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cacheIndex.find(filePath, pathHash)) {
+        return;  // a demand miss loaded it meanwhile
+    }
+    installStaged(metadata, pathHash, staged);
+}
+
+std::shared_ptr<CacheEntry> ContentAwareCache::installStaged(const FileMetadata& metadata, uint64_t pathHash,
+                                                             CachePayload& staged) {
+    makeRoomInCache(metadata.fileSize);
+    
+    auto entry = CacheEntry::create(metadata.filePath, fileTypes.intern(metadata.fileType), metadata.fileSize);
+    if (metadata.fileSize > PayloadArena::MAX_BLOCK) {
+        entry->data.adopt(staged);
+    } else {
+        entry->data.resizeUninitialized(metadata.fileSize, payloadArena.get(), entry.get());
+        if (metadata.fileSize > 0) {
+            std::memcpy(entry->data.data(), staged.data(), metadata.fileSize);
+        }
+    }
     
-    // Update cache
-    cacheMap[filePath] = entry;
+    insertEntry(entry, pathHash);
+    stampSource(*entry, metadata);
     currentCacheSize += metadata.fileSize;
-    updateLRU(filePath);
     diskReads++;
-    
-    // Calculate initial score
     entry->priorityScore = calculatePriorityScore(entry);
+    return entry;
+}
+
+SourceStamp* ContentAwareCache::findStamp(const CacheEntry& entry) {
+    if (!hasRevalidation(entry.typeId) || entry.typeId >= entriesByType.size()) {
+        return nullptr;
+    }
+    // Entries no longer cached keep a stale position
+    const std::vector<CacheEntry*>& sameType = entriesByType[entry.typeId];
+    if (entry.typePosition >= sameType.size() || sameType[entry.typePosition] != &entry) {
+        return nullptr;
+    }
+    return &sourceStamps[entry.typeId][entry.typePosition];
+}
+
+void ContentAwareCache::stampSource(const CacheEntry& entry, const FileMetadata& metadata) {
+    SourceStamp* stamp = findStamp(entry);
+    if (!stamp) {
+        return;
+    }
+    // An empty or unreadable file leaves the cached contents as the reference
+    stamp->known = metadata.fileSize > 0;
+    stamp->modified = metadata.lastModified;
+    stamp->size = metadata.fileSize;
+    stamp->validatedTick = CoarseClock::now();
+    stamp->refreshing = false;
+}
+
+void ContentAwareCache::noteWritten(const CacheEntry& entry, const FileMetadata& written) {
+    // The cache's own writes are not changes to revalidate against
+    stampSource(entry, written);
+}
+
+IndexedEntry* ContentAwareCache::revalidateLocked(IndexedEntry& indexed, uint64_t pathHash,
+                                                  std::unique_lock<std::mutex>& lock) {
+    SourceStamp* stamp = findStamp(*indexed.entry);
+    if (!stamp || !stamp->known) {
+        return &indexed;
+    }
     
-    return true;
+    const RevalidationRule& rule = revalidationRules[indexed.entry->typeId];
+    uint32_t nowTick = CoarseClock::now();
+    uint32_t age = CoarseClock::elapsed(stamp->validatedTick, nowTick);
+    if (age <= rule.maxAgeTicks) {
+        return &indexed;
+    }
+    
+    if (age <= rule.maxAgeTicks + rule.staleTicks) {
+        // Served as is; the first stale hit queues the refresh. Without a
+        // pool it stays stale until a hit past the window checks the disk.
+        staleHits++;
+        if (!stamp->refreshing) {
+            CacheExecutor* pool = getExecutor();
+            std::weak_ptr<CacheEntry> stale = indexed.entry;
+            stamp->refreshing = pool && pool->submit(TaskLane::Prefetch,
+                [this, path = indexed.entry->filePath, pathHash, stale] { refreshEntry(path, pathHash, stale); });
+        }
+        return &indexed;
+    }
+    
+    // Too old to serve unchecked: the caller waits for the disk, as on a miss.
+    // The stat runs without the lock, and misses and writes of the path wait for it.
+    blockingRevalidations++;
+    std::shared_ptr<CacheEntry> entry = indexed.entry;
+    std::string path = entry->filePath;
+    pendingLoads.emplace_back(pathHash, path);
+    lock.unlock();
+    FileMetadata metadata = getFileMetadata(path);
+    lock.lock();
+    finishLoad(pathHash, path);
+    
+    // The index may have changed meanwhile
+    auto* slot = cacheIndex.find(path, pathHash);
+    if (!slot || slot->value.entry != entry) {
+        return slot ? &slot->value : nullptr;  // evicted, or replaced by newer contents
+    }
+    stamp = findStamp(*entry);
+    if (stamp && stamp->known) {
+        if (!sourceUnchanged(*stamp, metadata)) {
+            evictFile(path);
+            return nullptr;
+        }
+        stamp->validatedTick = CoarseClock::now();
+    }
+    return &slot->value;
 }
 
-void ContentAwareCache::evictFile(const std::string& filePath) {
-    auto it = cacheMap.find(filePath);
-    if (it == cacheMap.end()) {
+void ContentAwareCache::refreshEntry(const std::string& filePath, uint64_t pathHash,
+                                     const std::weak_ptr<CacheEntry>& stale) {
+    std::shared_ptr<CacheEntry> entry = stale.lock();
+    if (!entry) {
         return;
     }
     
-    // Flush changes if needed
-    CacheEntry& entry = *(it->second);
+    // Stamp of the entry while it is still the cached one for the path
+    auto currentStamp = [&]() -> SourceStamp* {
+        auto* slot = cacheIndex.find(filePath, pathHash);
+        return slot && slot->value.entry == entry ? findStamp(*entry) : nullptr;
+    };
+    
+    FileMetadata metadata = getFileMetadata(filePath);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        SourceStamp* stamp = currentStamp();
+        if (!stamp) {
+            return;
+        }
+        if (sourceUnchanged(*stamp, metadata)) {
+            stamp->validatedTick = CoarseClock::now();
+            stamp->refreshing = false;
+            return;
+        }
+        if (metadata.fileSize == 0 || metadata.fileSize > CachePayload::MAX_SIZE) {
+            // Gone or no longer cacheable; the next open goes to the disk
+            evictFile(filePath);
+            return;
+        }
+    }
     
-    // Update cache size
+    // Read without the lock, like a prefetch; hits keep getting the old contents
+    CachePayload staged;
+    bool read = readStaged(metadata, staged, IoClass::Prefetch);
+    
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    SourceStamp* stamp = currentStamp();
+    if (!stamp) {
+        return;  // evicted, reloaded or rewritten meanwhile
+    }
+    if (!read) {
+        // Unreadable now; rather than serve the old contents until the window
+        // ends, the next open goes to the disk
+        evictFile(filePath);
+        return;
+    }
+    
+    // Replaced like an eviction and a load, keeping the entry's access history.
+    // Open handles keep reading the old contents.
+    AccessStats history = entry->stats;
+    evictFile(filePath);
+    auto fresh = installStaged(metadata, pathHash, staged);
+    fresh->stats = history;
+    fresh->priorityScore = calculatePriorityScore(fresh);
+    backgroundRefreshes++;
+}
+
+void ContentAwareCache::evictFile(std::string_view filePath) {
+    auto* slot = cacheIndex.find(filePath);
+    if (!slot) {
+        return;
+    }
+    
+    CacheEntry& entry = *slot->value.entry;
+    invalidateReplicas(entry);
+    
+    // Update cache size; bytes still held by handles stay counted until they close
     currentCacheSize -= entry.getMemoryUsage();
+    if (entry.openHandles > 0) {
+        entry.evicted = true;
+        zombieBytes += entry.getMemoryUsage();
+    }
     
-    // Remove from LRU
-    auto lruIt = lruMap.find(filePath);
-    if (lruIt != lruMap.end()) {
-        lruList.erase(lruIt->second);
-        lruMap.erase(lruIt);
+    // Remove from its type's list, moving the last entry into its place
+    std::vector<CacheEntry*>& sameType = entriesByType[entry.typeId];
+    sameType[entry.typePosition] = sameType.back();
+    sameType[entry.typePosition]->typePosition = entry.typePosition;
+    sameType.pop_back();
+    if (hasRevalidation(entry.typeId)) {
+        std::vector<SourceStamp>& stamps = sourceStamps[entry.typeId];
+        stamps[entry.typePosition] = stamps.back();
+        stamps.pop_back();
     }
     
-    // Remove from cache
-    cacheMap.erase(it);
+    // Remove from LRU and the index
+    lruList.erase(slot->value.lruPosition);
+    cacheIndex.erase(slot);
 }
 
 void ContentAwareCache::makeRoomInCache(size_t requiredSize) {
     // Quick return if we have enough space
-    if (currentCacheSize + requiredSize <= maxCacheSize) {
+    if (currentCacheSize + zombieBytes + requiredSize <= maxCacheSize) {
         return;
     }
     
+    // Scores must include accesses still waiting in the per-thread buffers
+    applyPendingAccesses();
+    
+    // Entries pinned by replicas of exited threads can go now
+    reclaimOrphanedReplicas();
+    
     // Update all scores before eviction
     updateAllScores();
     
     // Evict files until we have enough space
-    while (currentCacheSize + requiredSize > maxCacheSize && !cacheMap.empty()) {
+    while (currentCacheSize + zombieBytes + requiredSize > maxCacheSize && !cacheIndex.empty()) {
         std::string victimPath = findEntryForEviction();
         if (victimPath.empty()) {
             break;
@@ -327,63 +1036,581 @@ void ContentAwareCache::makeRoomInCache(size_t requiredSize) {
         evictFile(victimPath);
     }
     
-    // If still not enough space, increase max cache size
+    // Close the holes evicted small payloads left in the arena
+    payloadArena->compact();
+    
+    // If still not enough space, increase max cache size. Zombie bytes alone
+    // don't raise it; they are freed as their handles close.
     if (currentCacheSize + requiredSize > maxCacheSize) {
         maxCacheSize = currentCacheSize + requiredSize;
     }
 }
 
-void ContentAwareCache::updateEntryScore(const std::string& filePath) {
-    auto it = cacheMap.find(filePath);
-    if (it != cacheMap.end()) {
-        it->second->priorityScore = calculatePriorityScore(it->second);
+void ContentAwareCache::updateAllScores() {
+    uint32_t nowTick = CoarseClock::now();
+    cacheIndex.forEach([&](IndexedEntry& indexed) {
+        indexed.entry->priorityScore = calculatePriorityScore(*indexed.entry, nowTick);
+    });
+}
+
+AccessBuffer* ContentAwareCache::getAccessBuffer() {
+    if (cachedBufferCacheId == cacheId) {
+        return cachedBuffer;
+    }
+    
+    // First close on this thread for this cache (or since using another cache)
+    std::lock_guard<std::mutex> lock(accessBufferMutex);
+    std::thread::id self = std::this_thread::get_id();
+    AccessBuffer* buffer = accessBuffers.load(std::memory_order_relaxed);
+    while (buffer && buffer->owner != self) {
+        buffer = buffer->next;
     }
+    if (!buffer) {
+        buffer = new AccessBuffer(self);
+        buffer->next = accessBuffers.load(std::memory_order_relaxed);
+        accessBuffers.store(buffer, std::memory_order_release);
+    }
+    
+    cachedBufferCacheId = cacheId;
+    cachedBuffer = buffer;
+    return buffer;
 }
 
-void ContentAwareCache::updateAllScores() {
-    for (auto& pair : cacheMap) {
-        pair.second->priorityScore = calculatePriorityScore(pair.second);
+HotReplicaSet* ContentAwareCache::getReplicaSet() {
+    if (cachedReplicaSetCacheId == cacheId) {
+        return cachedReplicaSet;
+    }
+    
+    std::lock_guard<std::mutex> lock(accessBufferMutex);
+    std::thread::id self = std::this_thread::get_id();
+    HotReplicaSet* replicas = replicaSets.load(std::memory_order_relaxed);
+    // Thread ids are reused, so an orphaned set is never taken over
+    while (replicas && (replicas->owner != self || replicas->orphaned.load(std::memory_order_acquire))) {
+        replicas = replicas->next;
+    }
+    if (!replicas) {
+        replicas = new HotReplicaSet(self, replicaEpoch.load(std::memory_order_acquire));
+        replicas->next = replicaSets.load(std::memory_order_relaxed);
+        replicaSets.store(replicas, std::memory_order_release);
+        
+        auto& owned = replicaSetOwnership.sets;
+        owned.erase(std::remove_if(owned.begin(), owned.end(),
+                                   [](const auto& set) { return set.first.expired(); }),
+                    owned.end());
+        owned.emplace_back(weak_from_this(), replicas);
+    }
+    
+    cachedReplicaSetCacheId = cacheId;
+    cachedReplicaSet = replicas;
+    return replicas;
+}
+
+CacheFile ContentAwareCache::openFromReplica(HotReplicaSet& replicas, std::string_view filePath,
+                                             uint64_t pathHash, uint8_t modeFlags) {
+    // Announced before the epoch is read, so a revocation either waits for
+    // this open or is seen by it (both sides are sequentially consistent)
+    replicas.serving.store(true, std::memory_order_seq_cst);
+    if (replicas.epoch != replicaEpoch.load(std::memory_order_seq_cst)) {
+        replicas.serving.store(false, std::memory_order_release);
+        return CacheFile();
+    }
+    
+    const std::shared_ptr<HotReplica>& replica = replicas.replicas[HotReplicaSet::slotOf(pathHash)];
+    if (!replica || replica->pathHash != pathHash || replica->path != filePath ||
+        replica->pendingOpens >= HotReplicaSet::SYNC_INTERVAL) {
+        replicas.serving.store(false, std::memory_order_release);
+        return CacheFile();
+    }
+    replica->pendingOpens++;
+    replicas.countHit();
+    
+    // Shares the replica's ownership and snapshot. Without a cache pointer the
+    // handle reads only; closing it just releases the replica.
+    CacheFile file;
+    file.entry = std::shared_ptr<CacheEntry>(replica, replica->view.entry.get());
+    file.snapshot = replica->view.snapshot;
+    file.modeFlags = modeFlags;
+    file.cacheHit = true;
+    replicas.serving.store(false, std::memory_order_release);
+    return file;
+}
+
+void ContentAwareCache::settleReplicas(HotReplicaSet& replicas) {
+    uint32_t nowTick = CoarseClock::now();
+    for (auto& replica : replicas.replicas) {
+        if (replica) {
+            foldReplicaOpens(*replica, nowTick);
+        }
+    }
+    // Replicas that went stale were revoked when the epoch moved
+    replicas.epoch = replicaEpoch.load(std::memory_order_relaxed);
+}
+
+void ContentAwareCache::foldReplicaOpens(HotReplica& replica, uint32_t nowTick) {
+    if (replica.pendingOpens == 0) {
+        return;
+    }
+    
+    // Opens served from the replica count as accesses and refresh the LRU position
+    CacheEntry& entry = *replica.view.entry;
+    entry.stats.accessCount = static_cast<uint32_t>(
+        std::min<uint64_t>(uint64_t(entry.stats.accessCount) + replica.pendingOpens, UINT32_MAX));
+    entry.stats.lastAccessTick = nowTick;
+    entry.priorityScore = calculatePriorityScore(entry, nowTick);
+    auto* slot = cacheIndex.find(replica.path, replica.pathHash);
+    if (slot && slot->value.entry.get() == &entry) {
+        updateLRU(slot->value);
+    }
+    replica.pendingOpens = 0;
+}
+
+void ContentAwareCache::reclaimOrphanedReplicas() {
+    uint32_t nowTick = CoarseClock::now();
+    for (HotReplicaSet* replicas = replicaSets.load(std::memory_order_acquire); replicas;
+         replicas = replicas->next) {
+        if (!replicas->orphaned.load(std::memory_order_acquire)) {
+            continue;
+        }
+        
+        for (auto& replica : replicas->replicas) {
+            // Replicas still lent to open handles go with their last close. The
+            // rest are closed here, since queueing the close could need the lock.
+            if (!replica || replica.use_count() > 1) {
+                continue;
+            }
+            foldReplicaOpens(*replica, nowTick);
+            closeReplicaView(*replica);
+            replica.reset();
+        }
     }
+    
+    // Revoked replicas whose handles have all closed since
+    for (auto& replica : revokedReplicas) {
+        if (replica.use_count() == 1) {
+            closeReplicaView(*replica);
+            replica.reset();
+        }
+    }
+    revokedReplicas.erase(std::remove(revokedReplicas.begin(), revokedReplicas.end(), nullptr),
+                          revokedReplicas.end());
 }
 
-CacheFile* ContentAwareCache::openFile(const std::string& filePath, const std::string& mode) {
+void ContentAwareCache::closeReplicaView(HotReplica& replica) {
+    // Releases the pin only; the view's opens were counted as they were folded
+    CacheFile& view = replica.view;
+    view.pinned.reset();
+    view.snapshot = nullptr;
+    zombieBytes -= std::min(view.heldBytes, zombieBytes);
+    view.heldBytes = 0;
+    releaseHandle(*view.entry);
+    view.entry.reset();
+    view.cachePtr.reset();
+}
+
+void ContentAwareCache::noteReadHit(HotReplicaSet& replicas, const CacheFile& file, std::string_view filePath,
+                                    uint64_t pathHash, std::vector<std::shared_ptr<HotReplica>>& retired) {
+    // Replica opens bypass tracing and the miss-ratio estimator
+    if (traceRecorder || mrcEstimator) {
+        return;
+    }
+    // Nor would they be revalidated
+    if (hasRevalidation(file.entry->typeId)) {
+        return;
+    }
+    
+    size_t slot = HotReplicaSet::slotOf(pathHash);
+    std::shared_ptr<HotReplica>& replica = replicas.replicas[slot];
+    if (replica && replica->pathHash == pathHash) {
+        return;  // already replicated; this was a stats round trip
+    }
+    
+    HotReplicaSet::Candidate& candidate = replicas.candidates[slot];
+    if (candidate.pathHash != pathHash) {
+        candidate.pathHash = pathHash;
+        candidate.hits = 0;
+    }
+    if (++candidate.hits < HotReplicaSet::HOT_THRESHOLD) {
+        return;
+    }
+    candidate.hits = 0;
+    
+    if (replica) {
+        retired.push_back(std::move(replica));
+    }
+    replica = std::make_shared<HotReplica>();
+    replica->view = CacheFile(file.entry, MODE_READ, weak_from_this());
+    replica->view.entry->openHandles++;
+    replica->view.countsAccess = false;
+    replica->path = std::string(filePath);
+    replica->pathHash = pathHash;
+    replica->pendingOpens = 0;
+    file.entry->replicated = true;
+    if (numaReplication) {
+        localizeReplica(*replica);
+    }
+}
+
+void ContentAwareCache::localizeReplica(HotReplica& replica) {
+    const NumaTopology& topology = NumaTopology::get();
+    const CachePayload& contents = *replica.view.snapshot;
+    if (!topology.isMultiNode() || contents.empty() || contents.size() > MAX_NODE_LOCAL_COPY) {
+        return;
+    }
+    int node = topology.currentNode();
+    if (topology.nodeOfAddress(contents.data()) == node) {
+        return;
+    }
+    
+    // Fresh heap memory is placed on first touch, by this thread. The view
+    // still counts as an open handle, so the entry's own version stays put.
+    auto copy = std::make_shared<CachePayload>();
+    copy->resizeUninitialized(contents.size());
+    std::memcpy(copy->data(), contents.data(), contents.size());
+    if (topology.nodeOfAddress(copy->data()) != node) {
+        return;  // the heap reused remote memory; the copy would not help
+    }
+    replica.view.pinned = std::move(copy);
+    replica.view.snapshot = replica.view.pinned.get();
+    
+    // Held memory like a draft, given back when the view closes
+    zombieBytes += contents.size();
+    replica.view.heldBytes = contents.size();
+}
+
+void ContentAwareCache::invalidateReplicas(CacheEntry& entry) {
+    if (entry.replicated) {
+        entry.replicated = false;
+        revokeReplicas(&entry);
+    }
+}
+
+void ContentAwareCache::revokeReplicas(const CacheEntry* entry) {
+    replicaEpoch.fetch_add(1, std::memory_order_seq_cst);
+    
+    // Every thread's replicas of the entry (all replicas for nullptr) are
+    // dropped now, rather than when their thread next takes the lock
+    for (HotReplicaSet* replicas = replicaSets.load(std::memory_order_acquire); replicas;
+         replicas = replicas->next) {
+        // An open that read the old epoch is a few instructions from done
+        while (replicas->serving.load(std::memory_order_seq_cst)) {
+            std::this_thread::yield();
+        }
+        for (auto& replica : replicas->replicas) {
+            if (replica && (!entry || replica->view.entry.get() == entry)) {
+                releaseReplica(replica);
+            }
+        }
+    }
+}
+
+void ContentAwareCache::releaseReplica(std::shared_ptr<HotReplica>& replica) {
+    foldReplicaOpens(*replica, CoarseClock::now());
+    if (replica.use_count() == 1) {
+        closeReplicaView(*replica);
+        replica.reset();
+    } else {
+        // Handles opened from it still read its snapshot; the view closes after them
+        revokedReplicas.push_back(std::move(replica));
+    }
+}
+
+size_t ContentAwareCache::getReplicaHits() const {
+    size_t hits = 0;
+    for (HotReplicaSet* replicas = replicaSets.load(std::memory_order_acquire); replicas;
+         replicas = replicas->next) {
+        hits += replicas->getHits();
+    }
+    return hits;
+}
+
+void ContentAwareCache::recordAccess(std::shared_ptr<CacheEntry>&& entry, bool counted) {
+    uint32_t now = CoarseClock::now();
+    if (getAccessBuffer()->push(std::move(entry), now, counted)) {
+        return;
+    }
+    
+    // Buffer full: apply everything pending, then this access
     std::lock_guard<std::mutex> lock(cacheMutex);
+    applyPendingAccesses();
+    applyAccess(entry, now, counted);
+}
+
+void ContentAwareCache::applyAccess(const std::shared_ptr<CacheEntry>& entry, uint32_t accessTick, bool counted) {
+    if (!counted) {
+        releaseHandle(*entry);
+        return;
+    }
+    if (entry->stats.accessCount < UINT32_MAX) {
+        entry->stats.accessCount++;
+    }
+    releaseHandle(*entry);
+    // Buffers drain one thread at a time, so accesses can arrive out of order
+    if (CoarseClock::elapsed(entry->stats.lastAccessTick, accessTick) > 0) {
+        entry->stats.lastAccessTick = accessTick;
+    }
+    entry->priorityScore = calculatePriorityScore(*entry, accessTick);
+}
+
+void ContentAwareCache::releaseHandle(CacheEntry& entry) {
+    if (entry.openHandles > 0) {
+        entry.openHandles--;
+    }
+    if (entry.openHandles == 0) {
+        if (entry.latest && entry.latest.use_count() == 1) {
+            // The last reader of the old version is gone; move the newest into place
+            zombieBytes -= std::min(entry.data.size(), zombieBytes);
+            installPayload(entry, *entry.latest);
+            entry.latest.reset();
+        }
+        if (entry.evicted) {
+            // Last handle on an evicted entry; its memory goes when this reference drops
+            zombieBytes -= std::min(entry.getMemoryUsage(), zombieBytes);
+            entry.evicted = false;
+        }
+    }
+}
+
+void ContentAwareCache::publishDraft(CacheFile& file) {
+    // Exact open-handle counts decide whether the version can replace data in place
+    applyPendingAccesses();
+    
+    CacheEntry& entry = *file.entry;
+    CachePayload& draft = *file.draft;
+    // An appended tail goes after the newest version, which may already hold
+    // other handles' appends, rather than after this handle's snapshot
+    bool appends = file.appendsTail();
+    size_t newSize = appends ? entry.current().size() + draft.size() : draft.size();
+    invalidateReplicas(entry);
+    zombieBytes -= std::min(file.heldBytes, zombieBytes);
+    file.heldBytes = 0;
+    
+    // The handle was charged for the draft's growth past draftBase; replace
+    // that with the actual change from the version being replaced, in the pool
+    // (cache or zombie) the entry is counted in
+    size_t oldSize = entry.getMemoryUsage();
+    size_t charged = appends ? draft.size() : newSize - std::min(newSize, file.draftBase);
+    currentCacheSize -= std::min(charged, currentCacheSize);
+    size_t& pool = entry.evicted ? zombieBytes : currentCacheSize;
+    pool += newSize;
+    pool -= std::min(oldSize, pool);
+    
+    bool inPlace = entry.openHandles <= 1;
+    bool extendData = appends && inPlace && !entry.latest;
+    if (appends && !extendData) {
+        // Someone else still reads data, or latest is newer; the new version is a fresh copy
+        CachePayload tail;
+        tail.adopt(draft);
+        appendTail(draft, entry.current(), tail, payloadArena.get());
+    }
+    
+    if (inPlace) {
+        // Only this handle is open, so nobody reads data or latest
+        if (entry.latest) {
+            zombieBytes -= std::min(entry.data.size(), zombieBytes);
+            entry.latest.reset();
+        }
+        if (extendData) {
+            // Appends extend data where it is; the base is not copied
+            size_t baseSize = entry.data.size();
+            entry.data.resizeUninitialized(newSize, payloadArena.get(), &entry);
+            if (newSize > baseSize) {
+                std::memcpy(entry.data.data() + baseSize, draft.data(), newSize - baseSize);
+            }
+        } else {
+            installPayload(entry, draft);
+        }
+        file.pinned.reset();
+        file.snapshot = &entry.data;
+    } else {
+        // Readers keep the old version until they close. A previous latest still
+        // pinned by readers is freed with them, without being counted here.
+        if (!entry.latest) {
+            zombieBytes += entry.data.size();
+        }
+        auto version = std::make_shared<CachePayload>();
+        version->adopt(draft);
+        entry.latest = version;
+        file.pinned = std::move(version);
+        file.snapshot = file.pinned.get();
+    }
+    file.draft.reset();
+    file.draftBase = 0;
+    
+    entry.fileSize = static_cast<uint32_t>(std::min<size_t>(newSize, UINT32_MAX));
+    entry.priorityScore = calculatePriorityScore(file.entry);
+}
+
+void ContentAwareCache::installPayload(CacheEntry& entry, CachePayload& source) {
+    if (source.size() <= PayloadArena::MAX_BLOCK) {
+        // Small contents go back inline or into the arena
+        entry.data.clear();
+        entry.data.resizeUninitialized(source.size(), payloadArena.get(), &entry);
+        if (!source.empty()) {
+            std::memcpy(entry.data.data(), source.data(), source.size());
+        }
+    } else {
+        entry.data.adopt(source);
+    }
+}
+
+void ContentAwareCache::applyPendingAccesses() {
+    for (AccessBuffer* buffer = accessBuffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        buffer->drain([this](PendingAccess& access) {
+            applyAccess(access.entry, access.accessTick, access.counted);
+        });
+    }
+}
+
+CacheFile ContentAwareCache::open(std::string_view filePath, const std::string& mode) {
+    return openHashed(filePath, hashPath(filePath), parseOpenMode(mode));
+}
+
+CacheFile ContentAwareCache::open(std::string_view filePath, uint8_t modeFlags) {
+    return openHashed(filePath, hashPath(filePath), modeFlags);
+}
+
+CacheFile ContentAwareCache::open(const PathKey& key, const std::string& mode) {
+    return openHashed(key.getPath(), key.getHash(), parseOpenMode(mode));
+}
+
+CacheFile ContentAwareCache::open(const PathKey& key, uint8_t modeFlags) {
+    return openHashed(key.getPath(), key.getHash(), modeFlags);
+}
+
+CacheFile ContentAwareCache::openHashed(std::string_view filePath, uint64_t pathHash, uint8_t modeFlags) {
+    if (modeFlags & MODE_INVALID) {
+        return CacheFile();
+    }
+    
+    // Read-only opens of files this thread keeps reading skip the lock
+    HotReplicaSet* replicas = nullptr;
+    if ((modeFlags & ~MODE_BINARY) == MODE_READ) {
+        replicas = getReplicaSet();
+        CacheFile file = openFromReplica(*replicas, filePath, pathHash, modeFlags);
+        if (file) {
+            return file;
+        }
+    }
+    
+    // Replicas dropped under the lock are released after it, as closing their views may take it
+    std::vector<std::shared_ptr<HotReplica>> retired;
+    std::unique_lock<std::mutex> lock(cacheMutex);
+    applyPendingAccesses();
+    if (replicas) {
+        settleReplicas(*replicas);
+    }
+    if (!revokedReplicas.empty()) {
+        retired.insert(retired.end(), std::make_move_iterator(revokedReplicas.begin()),
+                       std::make_move_iterator(revokedReplicas.end()));
+        revokedReplicas.clear();
+    }
+    
+    // A miss releases the lock while it reads the file
+    CacheFile file = openLocked(filePath, pathHash, modeFlags, lock);
+    if (file) {
+        // Pins the payload in place until the close is applied
+        file.entry->openHandles++;
+        if (replicas && file.cacheHit) {
+            noteReadHit(*replicas, file, filePath, pathHash, retired);
+        }
+    }
     
-    // Check if file is already in cache
-    auto it = cacheMap.find(filePath);
-    if (it != cacheMap.end()) {
+    if (mrcEstimator && file) {
+        // hashPath() matches std::hash<std::string>, so sampling is unchanged
+        uint64_t keyHash = mixSampleHash(pathHash);
+        mrcEstimator->recordAccess(keyHash, file.entry->getMemoryUsage());
+    }
+    
+    if (traceRecorder) {
+        uint32_t pathId = traceRecorder->internPath(std::string(filePath));
+        size_t fileSize = file ? file.contents().size() : 0;
+        traceRecorder->record(TraceOp::Open, pathId, 0, fileSize, traceModeFromFlags(modeFlags));
+        if (file) {
+            file.trace = traceRecorder;
+            file.tracePathId = pathId;
+        }
+    }
+    
+    return file;
+}
+
+CacheFile ContentAwareCache::openLocked(std::string_view filePath, uint64_t pathHash, uint8_t modeFlags,
+                                        std::unique_lock<std::mutex>& lock) {
+    // Check if file is already in cache. Null when it changed on disk and was
+    // evicted; loaded again below as a miss.
+    auto* slot = cacheIndex.find(filePath, pathHash);
+    IndexedEntry* cached = slot ? revalidateLocked(slot->value, pathHash, lock) : nullptr;
+    if (!cached && isLoading(filePath, pathHash)) {
+        // The path is being read, or its newer contents written back; the
+        // result decides whether this is a hit
+        loadFinished.wait(lock, [&] { return !isLoading(filePath, pathHash); });
+        slot = cacheIndex.find(filePath, pathHash);
+        cached = slot ? &slot->value : nullptr;
+    }
+    if (cached) {
         // File is in cache
         cacheHits++;
-        updateLRU(filePath);
-        return new CacheFile(it->second, mode, weak_from_this());
+        if (modeFlags & MODE_EXCLUSIVE) {
+            return CacheFile();
+        }
+        updateLRU(*cached);
+        CacheFile file(cached->entry, modeFlags, weak_from_this());
+        file.cacheHit = true;
+        
+        if (modeFlags & MODE_TRUNCATE) {
+            // Writes start from an empty draft; other handles keep the old
+            // contents until it is published, and the disk sees it on close
+            file.draft.reset(new CachePayload());
+            file.modified = true;
+        }
+        return file;
     }
     
     // File not in cache
     cacheMisses++;
     
-    // Check if file exists for reading
-    if (mode.find('r') != std::string::npos && !fs::exists(filePath)) {
-        return nullptr;
+    // The new entry and the filesystem need an owned path
+    std::string path(filePath);
+    bool exists = fs::exists(path);
+    if (exists ? (modeFlags & MODE_EXCLUSIVE) : !(modeFlags & MODE_CREATE)) {
+        return CacheFile();
     }
     
-    // Create empty file for writing
-    if (mode.find('w') != std::string::npos) {
-        FileMetadata metadata = getFileMetadata(filePath);
-        metadata.fileSize = 0; // Start with empty file
-        
-        auto entry = std::make_shared<CacheEntry>(metadata);
-        cacheMap[filePath] = entry;
-        updateLRU(filePath);
+    // New or truncated file starts out empty
+    if (!exists || (modeFlags & MODE_TRUNCATE)) {
+        FileTypeId typeId = fileTypes.intern(FileTypeTable::extensionOf(path));
+        auto entry = CacheEntry::create(path, typeId, 0);
+        insertEntry(entry, pathHash);
+        entry->priorityScore = calculatePriorityScore(entry);
         
-        return new CacheFile(entry, mode, weak_from_this());
+        // Created or truncated on disk when the handle is closed, as fopen would
+        CacheFile file(entry, modeFlags, weak_from_this());
+        file.modified = true;
+        return file;
     }
     
-    // Load existing file for reading or appending
-    if (loadFileIntoCache(filePath)) {
-        return new CacheFile(cacheMap[filePath], mode, weak_from_this());
+    // Load existing file for reading, updating or appending
+    if (auto entry = loadFileIntoCache(path, pathHash, lock)) {
+        return CacheFile(std::move(entry), modeFlags, weak_from_this());
     }
     
-    return nullptr;
+    return CacheFile();
+}
+
+CacheFile* ContentAwareCache::openFile(std::string_view filePath, const std::string& mode) {
+    CacheFile file = open(filePath, mode);
+    if (!file) {
+        return nullptr;
+    }
+    return new CacheFile(std::move(file));
+}
+
+CacheFile* ContentAwareCache::openFile(const PathKey& key, const std::string& mode) {
+    CacheFile file = open(key, mode);
+    if (!file) {
+        return nullptr;
+    }
+    return new CacheFile(std::move(file));
 }
 
 bool ContentAwareCache::closeFile(CacheFile* file) {
@@ -394,31 +1621,212 @@ bool ContentAwareCache::closeFile(CacheFile* file) {
     return false;
 }
 
+void ContentAwareCache::insert(std::string_view filePath, const void* contents, size_t size) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    applyPendingAccesses();
+    
+    evictFile(filePath);
+    makeRoomInCache(size);
+    
+    std::string path(filePath);
+    auto entry = CacheEntry::create(path, fileTypes.intern(FileTypeTable::extensionOf(path)), size);
+    entry->data.resizeUninitialized(size, payloadArena.get(), entry.get());
+    if (size > 0) {
+        std::memcpy(entry->data.data(), contents, size);
+    }
+    
+    // Revalidation stamps stay unknown: the cached contents are newer than the disk
+    entry->dirty = true;
+    insertEntry(entry, hashPath(path));
+    currentCacheSize += size;
+    entry->priorityScore = calculatePriorityScore(entry);
+}
+
 void ContentAwareCache::flush() {
+    // The caller waits for it, so it is demand I/O. Hits go on while it runs.
+    std::vector<WriteBackPin> pins = pinForWriteBack();
+    writePinned(pins, IoClass::Demand);
+}
+
+std::vector<WriteBackPin> ContentAwareCache::pinForWriteBack() {
+    std::vector<WriteBackPin> pins;
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    applyPendingAccesses();
+    cacheIndex.forEach([&](IndexedEntry& indexed) {
+        CacheEntry& entry = *indexed.entry;
+        if (!entry.dirty || isLoading(entry.filePath, hashPath(entry.filePath))) {
+            return;  // the disk already has these contents, or a handle is writing them
+        }
+        // Set again if the write fails or the entry changes meanwhile
+        entry.dirty = false;
+        entry.openHandles++;
+        pins.push_back({indexed.entry, entry.latest, &entry.current()});
+        // Misses on the path wait for the new file instead of reading the old one
+        pendingLoads.emplace_back(hashPath(entry.filePath), entry.filePath);
+    });
+    return pins;
+}
+
+void ContentAwareCache::writePinned(std::vector<WriteBackPin>& pins, IoClass ioClass) {
+    size_t written = 0;
+    std::vector<bool> succeeded(pins.size());
+    std::vector<FileMetadata> writtenFiles(pins.size());
+    std::exception_ptr failure;
+    for (size_t i = 0; i < pins.size(); i++) {
+        const WriteBackPin& pin = pins[i];
+        try {
+            if (writeReplacing(pin.entry->filePath, *pin.contents, &ioScheduler, ioClass, WRITE_BACK_CHUNK)) {
+                // Stat'ed here, as the lock isn't held yet
+                writtenFiles[i] = getFileMetadata(pin.entry->filePath);
+                succeeded[i] = true;
+                written++;
+            }
+        } catch (...) {
+            // Still unpin every entry below; the first error goes to the caller
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+    
+    // Unpin like a closing handle, without counting an access
     std::lock_guard<std::mutex> lock(cacheMutex);
+    for (size_t i = 0; i < pins.size(); i++) {
+        WriteBackPin& pin = pins[i];
+        if (succeeded[i]) {
+            noteWritten(*pin.entry, writtenFiles[i]);
+        } else {
+            pin.entry->dirty = true;
+        }
+        finishLoad(hashPath(pin.entry->filePath), pin.entry->filePath);
+        pin.version.reset();
+        releaseHandle(*pin.entry);
+    }
+    diskWrites += written;
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+CacheExecutor* ContentAwareCache::getExecutor() {
+    std::lock_guard<std::mutex> lock(executorMutex);
+    if (!executor && !executorStopped) {
+        executor.reset(new CacheExecutor(executorOptions));
+    }
+    return executor.get();
+}
+
+bool ContentAwareCache::configureExecutor(const ExecutorOptions& options) {
+    std::lock_guard<std::mutex> lock(executorMutex);
+    if (executor || executorStopped) {
+        return false;
+    }
+    executorOptions = options;
+    return true;
+}
+
+bool ContentAwareCache::prefetch(std::string_view filePath) {
+    CacheExecutor* pool = getExecutor();
+    if (!pool) {
+        return false;
+    }
     
-    for (auto& pair : cacheMap) {
-        auto entry = pair.second;
+    std::string path(filePath);
+    uint64_t pathHash = hashPath(path);
+    // Not an access: no hit or miss is counted and nothing is traced
+    return pool->submit(TaskLane::Prefetch, [this, path = std::move(path), pathHash] {
+        prefetchFile(path, pathHash);
+    });
+}
+
+std::future<CacheFile> ContentAwareCache::openAsync(std::string_view filePath, const std::string& mode) {
+    auto task = std::make_shared<std::packaged_task<CacheFile()>>(
+        [this, path = std::string(filePath), mode] { return open(path, mode); });
+    std::future<CacheFile> result = task->get_future();
+    
+    CacheExecutor* pool = getExecutor();
+    if (!pool || !pool->submit(TaskLane::Demand, [task] { (*task)(); })) {
+        (*task)();
+    }
+    return result;
+}
+
+std::future<void> ContentAwareCache::flushAsync() {
+    std::vector<WriteBackPin> pins = pinForWriteBack();
+    
+    // Shared by the batches; the last one to finish completes the future
+    struct FlushState {
+        std::promise<void> done;
+        std::atomic<size_t> remaining{0};
+        std::mutex failureMutex;
+        std::exception_ptr failure;
+    };
+    auto state = std::make_shared<FlushState>();
+    std::future<void> result = state->done.get_future();
+    if (pins.empty()) {
+        state->done.set_value();
+        return result;
+    }
+    
+    state->remaining = (pins.size() + WRITE_BACK_BATCH - 1) / WRITE_BACK_BATCH;
+    CacheExecutor* pool = getExecutor();
+    
+    for (size_t first = 0; first < pins.size(); first += WRITE_BACK_BATCH) {
+        auto batch = std::make_shared<std::vector<WriteBackPin>>(
+            std::make_move_iterator(pins.begin() + first),
+            std::make_move_iterator(pins.begin() + std::min(first + WRITE_BACK_BATCH, pins.size())));
         
-        std::ofstream file(entry->metadata.filePath, std::ios::binary);
-        if (file) {
-            file.write(entry->data.data(), entry->data.size());
-            if (file) {
-                diskWrites++;
+        auto writeBatch = [this, batch, state] {
+            // The pool drops a task's exception, so hand it to the future instead
+            try {
+                writePinned(*batch, IoClass::WriteBack);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->failureMutex);
+                if (!state->failure) {
+                    state->failure = std::current_exception();
+                }
             }
+            batch->clear();
+            
+            if (state->remaining.fetch_sub(1) == 1) {
+                if (state->failure) {
+                    state->done.set_exception(state->failure);
+                } else {
+                    state->done.set_value();
+                }
+            }
+        };
+        
+        if (!pool || !pool->submit(TaskLane::WriteBack, writeBatch)) {
+            writeBatch();
         }
     }
+    return result;
 }
 
 void ContentAwareCache::clear() {
+    flush();  // Write all changes to disk first, without holding the lock
+    
     std::lock_guard<std::mutex> lock(cacheMutex);
+    applyPendingAccesses();
     
-    flush();  // Write all changes to disk first
+    // Entries with open handles become zombies; handles' write reservations stay counted
+    cacheIndex.forEach([&](IndexedEntry& indexed) {
+        CacheEntry& entry = *indexed.entry;
+        invalidateReplicas(entry);
+        currentCacheSize -= std::min(entry.getMemoryUsage(), currentCacheSize);
+        if (entry.openHandles > 0) {
+            entry.evicted = true;
+            zombieBytes += entry.getMemoryUsage();
+        }
+    });
     
-    cacheMap.clear();
+    cacheIndex.clear();
     lruList.clear();
-    lruMap.clear();
-    currentCacheSize = 0;
+    entriesByType.clear();
+    for (std::vector<SourceStamp>& stamps : sourceStamps) {
+        stamps.clear();
+    }
 }
 
 void ContentAwareCache::resizeCache(size_t newMaxSize) {
@@ -432,6 +1840,74 @@ void ContentAwareCache::resizeCache(size_t newMaxSize) {
     maxCacheSize = newMaxSize;
 }
 
+bool ContentAwareCache::enableHugePageArena(size_t reserveBytes) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    
+    // Headers and 4KB rounding take a little more than the payload bytes
+    size_t bytes = reserveBytes ? reserveBytes : maxCacheSize + maxCacheSize / 8;
+    return payloadArena->reserveLargeRegion(bytes) != PayloadArena::REGION_NONE;
+}
+
+void ContentAwareCache::setNumaReplication(bool enabled) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (numaReplication != enabled) {
+        numaReplication = enabled;
+        // Existing replicas are remade under the new setting
+        revokeReplicas(nullptr);
+    }
+}
+
+std::unordered_map<std::string, float> ContentAwareCache::defaultFileTypePriorities() {
+    std::unordered_map<std::string, float> priorities;
+    for (const BuiltinFileType& type : BUILTIN_FILE_TYPES) {
+        priorities.emplace(type.extension, type.priority);
+    }
+    return priorities;
+}
+
+void ContentAwareCache::setRevalidation(const std::string& extension, std::chrono::milliseconds maxAge,
+                                        std::chrono::milliseconds staleWhileRevalidate) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    
+    // Ensure extension starts with a dot
+    std::string ext = extension;
+    if (!ext.empty() && ext[0] != '.') {
+        ext = "." + ext;
+    }
+    
+    FileTypeId typeId = fileTypes.intern(ext);
+    if (typeId == FileTypeTable::OVERFLOW_TYPE) {
+        return;  // past the type limit; a rule would cover unrelated types
+    }
+    if (typeId >= revalidationRules.size()) {
+        revalidationRules.resize(typeId + 1);
+        sourceStamps.resize(typeId + 1);
+    }
+    if (typeId >= entriesByType.size()) {
+        entriesByType.resize(typeId + 1);
+    }
+    
+    bool wasEnabled = hasRevalidation(typeId);
+    revalidationRules[typeId].maxAgeTicks = ticksFor(maxAge);
+    revalidationRules[typeId].staleTicks = ticksFor(staleWhileRevalidate);
+    if (!hasRevalidation(typeId)) {
+        sourceStamps[typeId].clear();
+        return;
+    }
+    if (wasEnabled) {
+        return;
+    }
+    
+    // Files already cached are stamped with what is on disk now, and hot
+    // replicas are dropped so opens of this type come back to be checked
+    std::vector<SourceStamp>& stamps = sourceStamps[typeId];
+    stamps.assign(entriesByType[typeId].size(), SourceStamp());
+    for (CacheEntry* entry : entriesByType[typeId]) {
+        stampSource(*entry, getFileMetadata(entry->filePath));
+    }
+    revokeReplicas(nullptr);
+}
+
 void ContentAwareCache::setFileTypePriority(const std::string& extension, float priority) {
     std::lock_guard<std::mutex> lock(cacheMutex);
     
@@ -441,31 +1917,126 @@ void ContentAwareCache::setFileTypePriority(const std::string& extension, float
         ext = "." + ext;
     }
     
-    fileTypePriorities[ext] = std::max(0.0f, std::min(1.0f, priority));
+    applyPendingAccesses();
+    FileTypeId typeId = fileTypes.intern(ext);
+    fileTypes.setPriority(typeId, std::max(0.0f, std::min(1.0f, priority)));
     
     // Update scores for files of this type
-    for (auto& pair : cacheMap) {
-        if (pair.second->metadata.fileType == ext) {
-            pair.second->priorityScore = calculatePriorityScore(pair.second);
+    uint32_t nowTick = CoarseClock::now();
+    if (typeId < entriesByType.size()) {
+        for (CacheEntry* entry : entriesByType[typeId]) {
+            entry->priorityScore = calculatePriorityScore(*entry, nowTick);
+        }
+    }
+}
+
+void ContentAwareCache::setTraceRecorder(std::shared_ptr<TraceRecorder> recorder) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    traceRecorder = recorder;
+    // Opens must go through the lock to be traced, so hot replicas are dropped
+    revokeReplicas(nullptr);
+}
+
+void ContentAwareCache::enableMissRatioCurve(double samplingRate) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    
+    if (samplingRate <= 0.0) {
+        mrcEstimator.reset();
+    } else {
+        mrcEstimator.reset(new MissRatioCurveEstimator(samplingRate));
+    }
+    revokeReplicas(nullptr);
+}
+
+float ContentAwareCache::getPredictedHitRate(size_t cacheSize) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    
+    if (!mrcEstimator) {
+        return -1.0f;
+    }
+    return static_cast<float>(mrcEstimator->predictHitRate(cacheSize));
+}
+
+std::vector<std::pair<size_t, float>> ContentAwareCache::getHitRateCurve(size_t maxSize, size_t points) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    
+    std::vector<std::pair<size_t, float>> curve;
+    if (mrcEstimator) {
+        for (const auto& point : mrcEstimator->getCurve(maxSize, points)) {
+            curve.emplace_back(static_cast<size_t>(point.first), static_cast<float>(point.second));
         }
     }
+    return curve;
+}
+
+void ContentAwareCache::printHitRateCurve(size_t maxSize, size_t points) {
+    auto curve = getHitRateCurve(maxSize, points);
+    if (curve.empty()) {
+        std::cout << "Miss-ratio curve estimation is disabled." << std::endl;
+        return;
+    }
+    
+    std::cout << "Predicted Hit Rate by Cache Size (LRU, SHARDS sampling):" << std::endl;
+    for (const auto& point : curve) {
+        std::cout << "  " << (point.first / 1024) << " KB: " << (point.second * 100.0f) << "%"
+                  << " (miss ratio " << ((1.0f - point.second) * 100.0f) << "%)" << std::endl;
+    }
 }
 
 float ContentAwareCache::getHitRate() const {
-    size_t totalAccesses = cacheHits + cacheMisses;
+    size_t hits = cacheHits + getReplicaHits();
+    size_t totalAccesses = hits + cacheMisses;
     if (totalAccesses == 0) {
         return 0.0f;
     }
-    return static_cast<float>(cacheHits) / static_cast<float>(totalAccesses);
+    return static_cast<float>(hits) / static_cast<float>(totalAccesses);
 }
 
 void ContentAwareCache::printStats() const {
     std::cout << "Cache Statistics:" << std::endl;
     std::cout << "  Cache Size: " << currentCacheSize << " / " << maxCacheSize << " bytes" << std::endl;
-    std::cout << "  Cache Entries: " << cacheMap.size() << std::endl;
-    std::cout << "  Cache Hits: " << cacheHits << std::endl;
+    if (zombieBytes > 0) {
+        std::cout << "  Held by Open Handles: " << zombieBytes << " bytes (evicted or superseded)" << std::endl;
+    }
+    std::cout << "  Cache Entries: " << cacheIndex.size() << std::endl;
+    std::cout << "  Cache Hits: " << (cacheHits + getReplicaHits()) << std::endl;
     std::cout << "  Cache Misses: " << cacheMisses << std::endl;
     std::cout << "  Hit Rate: " << (getHitRate() * 100.0f) << "%" << std::endl;
     std::cout << "  Disk Reads: " << diskReads << std::endl;
     std::cout << "  Disk Writes: " << diskWrites << std::endl;
+    std::cout << "  Small-File Arena: " << payloadArena->getPageCount() << " pages, "
+              << payloadArena->getLiveBytes() << " bytes live" << std::endl;
+    static const char* const ioClassNames[IO_CLASS_COUNT] = {"demand", "write-back", "prefetch"};
+    if (!revalidationRules.empty()) {
+        std::cout << "  Revalidation: " << staleHits << " served stale, " << backgroundRefreshes
+                  << " refreshed in background, " << blockingRevalidations << " blocking checks" << std::endl;
+    }
+    std::cout << "  Disk I/O:";
+    for (size_t i = 0; i < IO_CLASS_COUNT; i++) {
+        IoClass ioClass = static_cast<IoClass>(i);
+        std::cout << (i ? ", " : " ") << ioClassNames[i] << " " << ioScheduler.getOps(ioClass) << " ops / "
+                  << ioScheduler.getBytes(ioClass) << " bytes";
+    }
+    std::cout << std::endl;
+    if (executor) {
+        std::cout << "  Background Tasks: " << executor->getCompletedTasks(TaskLane::Demand) << " demand, "
+                  << executor->getCompletedTasks(TaskLane::WriteBack) << " write-back, "
+                  << executor->getCompletedTasks(TaskLane::Prefetch) << " prefetch on "
+                  << executor->getThreadCount() << " threads (" << executor->getStolenTasks() << " stolen)"
+                  << std::endl;
+    }
+    const NumaTopology& topology = NumaTopology::get();
+    if (topology.isMultiNode()) {
+        std::cout << "  Arena Pages per NUMA Node:";
+        for (size_t node = 0; node < topology.getNodeCount(); node++) {
+            std::cout << " " << payloadArena->getPageCount(static_cast<int>(node));
+        }
+        std::cout << (numaReplication ? " (hot entries replicated per node)" : "") << std::endl;
+    }
+    PayloadArena::RegionBacking backing = payloadArena->getRegionBacking();
+    if (backing != PayloadArena::REGION_NONE) {
+        std::cout << "  Large-File Region: " << payloadArena->getRegionUsed() << " / "
+                  << payloadArena->getRegionSize() << " bytes, "
+                  << PayloadArena::regionBackingName(backing) << std::endl;
+    }
 }
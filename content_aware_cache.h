@@ -3,19 +3,38 @@
 #define CONTENT_AWARE_CACHE_H
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <list>
 #include <vector>
 #include <chrono>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <memory>
+#include <future>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
 #include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include "coarse_clock.h"
+#include "file_type_table.h"
+#include "payload_arena.h"
+#include "flat_path_index.h"
+#include "cache_executor.h"
+#include "io_scheduler.h"
 
 namespace fs = std::filesystem;
 
+class TraceRecorder;
+class MissRatioCurveEstimator;
+class AccessBuffer;
+class HotReplicaSet;
+struct HotReplica;
+struct WriteBackPin;
+
 // Struct to store file metadata
 struct FileMetadata {
     std::string filePath;
@@ -27,66 +46,322 @@ struct FileMetadata {
 
 // Struct to track file access statistics
 struct AccessStats {
-    size_t accessCount;
-    std::chrono::system_clock::time_point lastAccessed;
+    uint32_t accessCount;     // saturates at UINT32_MAX
+    uint32_t lastAccessTick;  // CoarseClock ticks
     
-    AccessStats() : accessCount(0) {
-        lastAccessed = std::chrono::system_clock::now();
-    }
+    AccessStats() : accessCount(0), lastAccessTick(CoarseClock::now()) {}
+};
+
+// Content-aware priority score from its four factors (higher = keep longer).
+// Shared by ContentAwareCache and the metadata-only simulator.
+float contentAwarePriorityScore(float typePriority, size_t fileSize, size_t accessCount,
+                                float secondsSinceAccess);
+
+// Where a CachePayload's bytes live
+enum PayloadStorage : uint64_t {
+    STORAGE_NONE = 0,
+    STORAGE_INLINE = 1,  // inside the owning entry's allocation
+    STORAGE_HEAP = 2,
+    STORAGE_ARENA = 3    // block in the cache's PayloadArena (small pages or large region)
 };
 
-// Cache entry representing a file in cache
+// Contents of a cached file: a byte buffer with 64-bit length, so files of
+// any size can be cached as before.
+// Starts out in storage inside the owning entry (see CacheEntry::create); when
+// the contents outgrow it they move to the cache's PayloadArena if small enough,
+// otherwise to the heap. Capacity grows geometrically, and loads and writes use
+// resizeUninitialized() so each byte is written once.
+class CachePayload {
+private:
+    char* bytes;
+    uint64_t length;
+    uint64_t capacity : 62;
+    uint64_t storage : 2;  // PayloadStorage
+    
+    void releaseStorage();
+    
+public:
+    // Largest payload a cache entry can hold (the width of the capacity field)
+    static constexpr size_t MAX_SIZE = (uint64_t(1) << 62) - 1;
+    
+    CachePayload() : bytes(nullptr), length(0), capacity(0), storage(STORAGE_NONE) {}
+    ~CachePayload() { releaseStorage(); }
+    
+    CachePayload(const CachePayload&) = delete;
+    CachePayload& operator=(const CachePayload&) = delete;
+    
+    // Uses storage owned by the entry until the contents outgrow it
+    void useInlineStorage(char* storage, size_t storageCapacity);
+    
+    char* data() { return bytes; }
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    size_t getCapacity() const { return capacity; }
+    PayloadStorage getStorage() const { return static_cast<PayloadStorage>(storage); }
+    
+    // Sets the length; new bytes are zero-filled. newSize must not exceed MAX_SIZE.
+    // Growth up to PayloadArena::MAX_BLOCK goes to the arena when one is given;
+    // larger growth uses the arena's huge-page region if reserved, else the heap.
+    void resize(size_t newSize, PayloadArena* arena = nullptr, CacheEntry* owner = nullptr);
+    // Same, but leaves new bytes uninitialized for callers about to overwrite them
+    void resizeUninitialized(size_t newSize, PayloadArena* arena = nullptr, CacheEntry* owner = nullptr);
+    // Grows capacity to at least minCapacity without changing the length
+    void reserve(size_t minCapacity, PayloadArena* arena = nullptr, CacheEntry* owner = nullptr);
+    void clear() { length = 0; }
+    
+    // Takes over other's heap storage, leaving other empty
+    void adopt(CachePayload& other);
+    
+    friend class PayloadArena;  // relocates blocks during compaction
+};
+
+// Cache entry representing a file in cache.
+//
+// Fields read by scoring and eviction come first, so together with the
+// shared_ptr control block they share the first cache line. Entries are made
+// with create(), which stores payloads up to MAX_INLINE_PAYLOAD bytes in the
+// same allocation.
+//
+// Contents are versioned. Handles read the version published when they opened
+// (or last flushed), and writers work on a private copy that flush publishes.
+// A version is published into data unless other handles are open; then it
+// waits in latest until they close, so their reads never change under them.
 class CacheEntry {
 public:
-    FileMetadata metadata;
-    AccessStats stats;
-    std::vector<char> data;
+    CachePayload data;
     float priorityScore;
+    AccessStats stats;
+    uint32_t fileSize;  // size when loaded, used for scoring
+    FileTypeId typeId;
+    bool evicted;          // out of the cache, but handles still hold it
+    bool replicated;       // some thread holds a hot replica of it (see hot_replicas.h)
+    uint32_t openHandles;  // open CacheFile handles, maintained under cacheMutex
+    std::shared_ptr<CachePayload> latest;  // newest version while older readers use data
+    uint32_t typePosition;  // index in the cache's list of entries of this type
+    bool dirty;             // newer than the file on disk, and no write of it is under way
+    std::string filePath;
     
-    CacheEntry(const FileMetadata& meta) : metadata(meta), priorityScore(0.0f) {}
+    static constexpr size_t MAX_INLINE_PAYLOAD = 200;
+    
+    // Allocates an entry sized for a payload of expectedSize bytes
+    static std::shared_ptr<CacheEntry> create(const std::string& filePath, FileTypeId typeId,
+                                              size_t expectedSize);
+    
+    CacheEntry(const std::string& filePath, FileTypeId typeId, size_t fileSize)
+        : priorityScore(0.0f),
+          fileSize(static_cast<uint32_t>(std::min<size_t>(fileSize, UINT32_MAX))),
+          typeId(typeId), evicted(false), replicated(false), openHandles(0), typePosition(0), dirty(false),
+          filePath(filePath) {}
+    
+    CacheEntry(const CacheEntry&) = delete;
+    CacheEntry& operator=(const CacheEntry&) = delete;
+    
+    // Newest published version
+    const CachePayload& current() const { return latest ? *latest : data; }
     
     size_t getMemoryUsage() const {
-        return data.size();
+        return current().size();
+    }
+};
+
+// Score of a cached entry at nowTick, with its type's priority taken from types
+float contentAwarePriorityScore(const FileTypeTable& types, const CacheEntry& entry, uint32_t nowTick);
+
+// Open mode flags, parsed once when a file is opened
+enum OpenModeFlags : uint8_t {
+    MODE_READ = 1 << 0,       // reads allowed
+    MODE_WRITE = 1 << 1,      // writes allowed
+    MODE_APPEND = 1 << 2,     // every write goes to the end of the file
+    MODE_TRUNCATE = 1 << 3,   // discard existing contents at open
+    MODE_CREATE = 1 << 4,     // create the file if it does not exist
+    MODE_EXCLUSIVE = 1 << 5,  // fail if the file already exists
+    MODE_BINARY = 1 << 6,     // accepted for fopen compatibility; no effect
+    MODE_INVALID = 1 << 7     // malformed mode string; open fails
+};
+
+// Parses an fopen-style mode string ("r", "w", "a", optionally followed by
+// '+', 'b', 't', glibc's 'e' and 'm' and, for "w" and "a", 'x') into
+// OpenModeFlags. constexpr, so modes known at compile time cost nothing at open:
+//     constexpr uint8_t kUpdate = parseOpenMode("r+b");
+constexpr uint8_t parseOpenMode(const char* mode) {
+    uint8_t flags = 0;
+    switch (mode[0]) {
+        case 'r': flags = MODE_READ; break;
+        case 'w': flags = MODE_WRITE | MODE_TRUNCATE | MODE_CREATE; break;
+        case 'a': flags = MODE_WRITE | MODE_APPEND | MODE_CREATE; break;
+        default: return MODE_INVALID;
     }
+    
+    for (const char* c = mode + 1; *c; c++) {
+        switch (*c) {
+            case '+': flags |= MODE_READ | MODE_WRITE; break;
+            case 'b': flags |= MODE_BINARY; break;
+            case 't': break;
+            case 'e': break;  // close-on-exec: the cache has no descriptor to pass on
+            case 'm': break;  // mmap reads: contents are in memory already
+            case 'x':
+                if (!(flags & MODE_CREATE)) {
+                    return MODE_INVALID;
+                }
+                flags |= MODE_EXCLUSIVE;
+                break;
+            default: return MODE_INVALID;
+        }
+    }
+    return flags;
+}
+
+inline uint8_t parseOpenMode(const std::string& mode) {
+    return parseOpenMode(mode.c_str());
+}
+
+// A file path with its index hash computed once. Callers that open the same
+// paths repeatedly can keep keys and skip hashing the path on every open.
+class PathKey {
+private:
+    std::string path;
+    uint64_t hash;
+    
+public:
+    explicit PathKey(std::string path) : path(std::move(path)), hash(hashPath(this->path)) {}
+    
+    const std::string& getPath() const { return path; }
+    uint64_t getHash() const { return hash; }
 };
 
-// File handle for cached files
+// File handle for cached files.
+// A movable value: moving transfers the open file, and the handle closes itself
+// when destroyed. A default-constructed or moved-from handle is closed.
 class CacheFile {
 private:
     std::shared_ptr<CacheEntry> entry;
+    const CachePayload* snapshot;          // published version this handle reads
+    std::shared_ptr<CachePayload> pinned;  // owns snapshot when it is entry->latest
+    std::unique_ptr<CachePayload> draft;   // private copy being written, published by flush()
+    size_t draftBase;                      // size of the version the draft started from
+    size_t heldBytes;                      // private copies (draft, local replica) in zombieBytes
     size_t position;
-    std::string mode;
+    uint8_t modeFlags;
     bool modified;
+    bool cacheHit;
+    bool countsAccess;  // false for a hot replica's view, whose opens are counted as served
     std::weak_ptr<class ContentAwareCache> cachePtr;
     
+    // Cache budget this handle reserved for growth but has not used yet. It is
+    // counted in currentCacheSize and backed by payload capacity, so writes
+    // within it skip cacheMutex; the rest is returned on close.
+    size_t reservedBytes;
+    
+    // Access trace hook (null unless tracing is enabled)
+    std::shared_ptr<TraceRecorder> trace;
+    uint32_t tracePathId;
+    
+    void releaseReservation();
+    CachePayload& beginWrite();
+    
+    // What reads see: this handle's own writes, else its snapshot
+    const CachePayload& contents() const { return draft ? *draft : *snapshot; }
+    
+    // A handle that can only append keeps just the appended bytes in its draft,
+    // which starts at file offset draftBase instead of holding a copy of the base
+    bool appendsTail() const { return (modeFlags & (MODE_APPEND | MODE_READ)) == MODE_APPEND; }
+    size_t draftOffset() const { return appendsTail() ? draftBase : 0; }
+    size_t contentsSize() const { return draft ? draftOffset() + draft->size() : snapshot->size(); }
+    
 public:
-    CacheFile(std::shared_ptr<CacheEntry> entry, const std::string& mode, 
+    // Growth reserved past what a write needs: the new size, within these bounds
+    static constexpr size_t MIN_WRITE_RESERVE = 4 * 1024;
+    static constexpr size_t MAX_WRITE_RESERVE = 1024 * 1024;
+    
+    CacheFile()
+        : snapshot(nullptr), draftBase(0), heldBytes(0), position(0), modeFlags(0), modified(false),
+          cacheHit(false), countsAccess(true), reservedBytes(0), tracePathId(0) {}
+    // Opens a handle on the entry's newest version (caller holds cacheMutex)
+    CacheFile(std::shared_ptr<CacheEntry> entry, uint8_t modeFlags,
               std::weak_ptr<class ContentAwareCache> cache)
-        : entry(entry), position(0), mode(mode), modified(false), cachePtr(cache) {}
+        : entry(std::move(entry)), snapshot(&this->entry->current()), pinned(this->entry->latest),
+          draftBase(0), heldBytes(0), position(0), modeFlags(modeFlags), modified(false), cacheHit(false),
+          countsAccess(true), cachePtr(std::move(cache)), reservedBytes(0), tracePathId(0) {}
+    
+    CacheFile(const CacheFile&) = delete;
+    CacheFile& operator=(const CacheFile&) = delete;
+    CacheFile(CacheFile&& other) noexcept;
+    CacheFile& operator=(CacheFile&& other) noexcept;
     
     ~CacheFile();
     
+    // True while the handle refers to an open file
+    bool isOpen() const { return entry != nullptr; }
+    explicit operator bool() const { return isOpen(); }
+    
+    // True if the file was already cached when it was opened
+    bool wasCacheHit() const { return cacheHit; }
+    
     size_t read(void* buffer, size_t size, size_t count);
     size_t write(const void* buffer, size_t size, size_t count);
     int seek(long offset, int origin);
     long tell();
+    // Publishes this handle's writes as the entry's newest version and writes it to disk
     int flush();
+    
+    // Flushes pending writes and queues the access for the entry's stats; the handle
+    // is closed afterwards
+    void close();
+    
+    friend class ContentAwareCache;
+};
+
+// What the cache index holds for a path: the entry and its node in the LRU list
+struct IndexedEntry {
+    std::shared_ptr<CacheEntry> entry;
+    std::list<CacheEntry*>::iterator lruPosition;
+    
+    const std::string& path() const { return entry->filePath; }
+};
+
+// Entry the content-aware policy evicts first: the lowest score, preferring
+// entries no handle has open, since evicting those frees memory now and the
+// others only once they close. Null if the index is empty.
+const CacheEntry* selectEvictionVictim(const FlatPathIndex<IndexedEntry>& index);
+
+// How long cached files of a type are trusted without checking the disk (setRevalidation)
+struct RevalidationRule {
+    uint32_t maxAgeTicks = 0;  // CoarseClock ticks; 0 means never revalidated
+    uint32_t staleTicks = 0;   // window past maxAge served stale while refreshing
+};
+
+// What the cache last saw of an entry's file on disk, for types with a rule
+struct SourceStamp {
+    fs::file_time_type modified;
+    uint64_t size = 0;
+    uint32_t validatedTick = 0;  // when the file was last loaded, written or found unchanged
+    bool known = false;          // false while the cached contents are newer than the disk
+    bool refreshing = false;     // a background refresh is queued
 };
 
 // Main cache manager class
 class ContentAwareCache : public std::enable_shared_from_this<ContentAwareCache> {
 private:
+    // Packed storage for small payloads. Declared first so it is released after
+    // every entry; it lives on while evicted entries are still held by handles.
+    std::unique_ptr<PayloadArena, PayloadArena::Releaser> payloadArena;
+    
     // Maximum cache size in bytes
     size_t maxCacheSize;
     // Current cache size in bytes
     size_t currentCacheSize;
+    // Bytes the cache no longer serves but open handles keep alive: evicted
+    // entries, versions superseded while being read, and handles' private
+    // copies (drafts, node-local replicas). They count against maxCacheSize
+    // until the handles close.
+    size_t zombieBytes;
     
-    // Cache storage: map from file path to cache entry
-    std::unordered_map<std::string, std::shared_ptr<CacheEntry>> cacheMap;
+    // Cache storage: flat hash index from file path to cache entry
+    FlatPathIndex<IndexedEntry> cacheIndex;
     
-    // LRU list for basic eviction policy backup
-    std::list<std::string> lruList;
-    std::unordered_map<std::string, std::list<std::string>::iterator> lruMap;
+    // LRU list for basic eviction policy backup; index slots point at their node
+    std::list<CacheEntry*> lruList;
     
     // Statistics
     size_t cacheHits;
@@ -97,35 +372,213 @@ private:
     // Thread safety
     std::mutex cacheMutex;
     
-    // File type priority weights (configurable)
-    std::unordered_map<std::string, float> fileTypePriorities;
+    // Interned file types and their priority weights (configurable)
+    FileTypeTable fileTypes;
+    
+    // Cached entries of each type, indexed by FileTypeId, so a priority change
+    // rescores only that type
+    std::vector<std::vector<CacheEntry*>> entriesByType;
+    
+    // Revalidation rules by FileTypeId, and for types with a rule a stamp per
+    // entry, parallel to entriesByType
+    std::vector<RevalidationRule> revalidationRules;
+    std::vector<std::vector<SourceStamp>> sourceStamps;
+    size_t staleHits;
+    size_t backgroundRefreshes;
+    size_t blockingRevalidations;
+    
+    // Optional access trace recorder
+    std::shared_ptr<TraceRecorder> traceRecorder;
+    
+    // Optional online miss-ratio-curve estimator (fed under cacheMutex)
+    std::unique_ptr<MissRatioCurveEstimator> mrcEstimator;
+    
+    // Hot replicas get node-local copies of remote payloads (setNumaReplication)
+    bool numaReplication;
+    
+    // Moves (under cacheMutex) when a replicated entry changes, before the
+    // replicas of it are revoked. Read on each replica open, so its line holds
+    // only fields that are rarely or never written.
+    alignas(64) std::atomic<uint64_t> replicaEpoch;
+    
+    // Revoked replicas still lent to open handles. The next open releases them
+    // after dropping cacheMutex, as their views may queue a close.
+    std::vector<std::shared_ptr<HotReplica>> revokedReplicas;
+    
+    // Per-thread buffers of accesses recorded at close, applied under cacheMutex,
+    // and per-thread hot-entry replicas. Lock-free lists; both are added under
+    // accessBufferMutex and live as long as the cache.
+    const uint64_t cacheId;
+    std::atomic<AccessBuffer*> accessBuffers;
+    std::atomic<HotReplicaSet*> replicaSets;
+    std::mutex accessBufferMutex;
+    
+    // Admission and rate limits for every disk read and write of file contents.
+    // Tickets are taken and held only without cacheMutex, so a throttled read
+    // or write never holds up hits.
+    IoScheduler ioScheduler;
+    
+    // Paths whose file is being read or written without cacheMutex: misses
+    // being loaded, and contents being flushed or written back. Misses on such
+    // a path (and other writes of it) wait on loadFinished, so they never read
+    // the file before a newer version is in place.
+    std::vector<std::pair<uint64_t, std::string>> pendingLoads;
+    std::condition_variable loadFinished;
+    
+    // Pool for background work, started on first use and drained by the destructor.
+    // Tasks refer to the cache by raw pointer and never own it.
+    std::unique_ptr<CacheExecutor> executor;
+    ExecutorOptions executorOptions;
+    bool executorStopped;
+    std::mutex executorMutex;
     
     // Helper methods
     FileMetadata getFileMetadata(const std::string& filePath);
     float calculatePriorityScore(const std::shared_ptr<CacheEntry>& entry);
-    void updateLRU(const std::string& filePath);
+    float calculatePriorityScore(const CacheEntry& entry, uint32_t nowTick);
+    void updateLRU(IndexedEntry& indexed);
+    void insertEntry(const std::shared_ptr<CacheEntry>& entry, uint64_t pathHash);
     std::string findEntryForEviction();
-    bool loadFileIntoCache(const std::string& filePath);
-    void evictFile(const std::string& filePath);
+    std::shared_ptr<CacheEntry> loadFileIntoCache(const std::string& filePath, uint64_t pathHash,
+                                                  std::unique_lock<std::mutex>& lock);
+    bool isLoading(std::string_view filePath, uint64_t pathHash) const;
+    void finishLoad(uint64_t pathHash, const std::string& filePath);
+    bool readStaged(const FileMetadata& metadata, CachePayload& staged, IoClass ioClass);
+    bool readFileContents(const std::string& filePath, char* destination, size_t size, IoClass ioClass);
+    void prefetchFile(const std::string& filePath, uint64_t pathHash);
+    std::shared_ptr<CacheEntry> installStaged(const FileMetadata& metadata, uint64_t pathHash,
+                                              CachePayload& staged);
+    bool hasRevalidation(FileTypeId typeId) const {
+        return typeId < revalidationRules.size() && revalidationRules[typeId].maxAgeTicks > 0;
+    }
+    SourceStamp* findStamp(const CacheEntry& entry);
+    void stampSource(const CacheEntry& entry, const FileMetadata& metadata);
+    void noteWritten(const CacheEntry& entry, const FileMetadata& written);
+    IndexedEntry* revalidateLocked(IndexedEntry& indexed, uint64_t pathHash, std::unique_lock<std::mutex>& lock);
+    void refreshEntry(const std::string& filePath, uint64_t pathHash, const std::weak_ptr<CacheEntry>& stale);
+    void evictFile(std::string_view filePath);
     void makeRoomInCache(size_t requiredSize);
-    void updateEntryScore(const std::string& filePath);
     void updateAllScores();
+    CacheFile openHashed(std::string_view filePath, uint64_t pathHash, uint8_t modeFlags);
+    CacheFile openLocked(std::string_view filePath, uint64_t pathHash, uint8_t modeFlags,
+                         std::unique_lock<std::mutex>& lock);
+    AccessBuffer* getAccessBuffer();
+    void recordAccess(std::shared_ptr<CacheEntry>&& entry, bool counted);
+    void applyAccess(const std::shared_ptr<CacheEntry>& entry, uint32_t accessTick, bool counted);
+    void releaseHandle(CacheEntry& entry);
+    void applyPendingAccesses();
+    std::vector<WriteBackPin> pinForWriteBack();
+    void writePinned(std::vector<WriteBackPin>& pins, IoClass ioClass);
+    void publishDraft(CacheFile& file);
+    void installPayload(CacheEntry& entry, CachePayload& source);
+    HotReplicaSet* getReplicaSet();
+    CacheFile openFromReplica(HotReplicaSet& replicas, std::string_view filePath, uint64_t pathHash,
+                              uint8_t modeFlags);
+    void settleReplicas(HotReplicaSet& replicas);
+    void noteReadHit(HotReplicaSet& replicas, const CacheFile& file, std::string_view filePath,
+                     uint64_t pathHash, std::vector<std::shared_ptr<HotReplica>>& retired);
+    void localizeReplica(HotReplica& replica);
+    void foldReplicaOpens(HotReplica& replica, uint32_t nowTick);
+    void reclaimOrphanedReplicas();
+    void invalidateReplicas(CacheEntry& entry);
+    void revokeReplicas(const CacheEntry* entry);
+    void releaseReplica(std::shared_ptr<HotReplica>& replica);
+    void closeReplicaView(HotReplica& replica);
+    size_t getReplicaHits() const;
+    CacheExecutor* getExecutor();
     
 public:
     ContentAwareCache(size_t maxSize = 64 * 1024 * 1024);  // Default 64MB cache
     ~ContentAwareCache();
     
-    // File operations
-    CacheFile* openFile(const std::string& filePath, const std::string& mode);
+    // File operations: open() returns a handle that closes itself when destroyed.
+    // Check isOpen() for failure. Modes follow fopen: "r" and "r+" need an
+    // existing file, "w"/"w+" truncate, "a"/"a+" append, "wx" fails if the file exists.
+    // Paths are taken as string_view, so const char* and string_view callers
+    // don't build a std::string unless the file has to be loaded.
+    CacheFile open(std::string_view filePath, const std::string& mode);
+    // Same, with flags from parseOpenMode() (constexpr for compile-time modes)
+    CacheFile open(std::string_view filePath, uint8_t modeFlags);
+    // Same, reusing the key's precomputed hash
+    CacheFile open(const PathKey& key, const std::string& mode);
+    CacheFile open(const PathKey& key, uint8_t modeFlags);
+    
+    // Heap-allocated handles, released with closeFile()
+    CacheFile* openFile(std::string_view filePath, const std::string& mode);
+    CacheFile* openFile(const PathKey& key, const std::string& mode);
     bool closeFile(CacheFile* file);
     
+    // Caches contents for a path without reading the disk, replacing any cached
+    // copy; handles already open keep the old contents. The disk sees them on
+    // the next flush, as if the file had been opened with "w" and written.
+    void insert(std::string_view filePath, const void* contents, size_t size);
+    
     // Cache management
     void flush();
     void clear();
     void resizeCache(size_t newMaxSize);
     
+    // Backs payloads above PayloadArena::MAX_BLOCK with a region of huge pages
+    // (reserveBytes, default the cache size). Falls back to transparent huge
+    // pages, then normal pages; returns false if no region could be reserved.
+    // Best called before the cache fills, as existing payloads stay where they are.
+    bool enableHugePageArena(size_t reserveBytes = 0);
+    
+    // Small payloads are always placed on the NUMA node of the thread that
+    // loads them. With replication on, a thread that replicates a hot entry
+    // whose payload sits on another node also gives its replica a local copy
+    // of up to MAX_NODE_LOCAL_COPY bytes. Each copy counts as held memory
+    // (getZombieBytes()) against the cache limit, like a write draft, until the
+    // replica is released. Has no effect on a single node.
+    static constexpr size_t MAX_NODE_LOCAL_COPY = 64 * 1024;
+    void setNumaReplication(bool enabled);
+    
+    // Background work runs on a work-stealing pool (cache_executor.h) that the
+    // cache starts on first use and drains in its destructor. Options only take
+    // effect before then; returns false once the pool is running.
+    bool configureExecutor(const ExecutorOptions& options);
+    // Loads the file in the background at prefetch priority unless it is
+    // cached. Returns false if the pool has shut down.
+    bool prefetch(std::string_view filePath);
+    // Opens the file on the pool at demand priority (on the caller once the
+    // pool has shut down)
+    std::future<CacheFile> openAsync(std::string_view filePath, const std::string& mode);
+    // Writes every cached file to disk on the pool at write-back priority. Each
+    // file is written as it was at the call, without holding the lock during
+    // I/O; the future is ready once all are written, and rethrows the first
+    // error raised while writing.
+    std::future<void> flushAsync();
+    
+    // Disk I/O is admitted by priority: demand first, then write-back, then
+    // prefetch, each class within its limits (io_scheduler.h)
+    void setIoLimits(IoClass ioClass, const IoClassLimits& limits) { ioScheduler.setLimits(ioClass, limits); }
+    const IoScheduler& getIoScheduler() const { return ioScheduler; }
+    
+    // Revalidation against the disk, per file type. A hit on a file checked
+    // less than maxAge ago is served as usual. Up to staleWhileRevalidate
+    // later it is still served at hit latency, and the first such hit queues
+    // one refresh at prefetch priority. Later hits block on a stat and, if the
+    // file changed, reload it like a miss. A maxAge of zero turns it off.
+    // Ignored for types past the type table's limit (FileTypeTable::OVERFLOW_TYPE).
+    void setRevalidation(const std::string& extension, std::chrono::milliseconds maxAge,
+                         std::chrono::milliseconds staleWhileRevalidate = std::chrono::milliseconds(0));
+    
     // Priority configuration
     void setFileTypePriority(const std::string& extension, float priority);
+    static std::unordered_map<std::string, float> defaultFileTypePriorities();
+    
+    // Access tracing: records open/read/write/close into the given recorder.
+    // Pass nullptr to stop tracing.
+    void setTraceRecorder(std::shared_ptr<TraceRecorder> recorder);
+    
+    // Miss-ratio curve estimation with spatially hashed sampling. Tracks
+    // about samplingRate of the opened paths; 0 disables it.
+    void enableMissRatioCurve(double samplingRate = 0.01);
+    // Predicted LRU hit rate (0.0-1.0) at the given cache size, or -1 if disabled
+    float getPredictedHitRate(size_t cacheSize);
+    // Predicted hit rates at evenly spaced sizes up to maxSize
+    std::vector<std::pair<size_t, float>> getHitRateCurve(size_t maxSize, size_t points);
+    void printHitRateCurve(size_t maxSize, size_t points);
     
     // Statistics
     float getHitRate() const;
@@ -135,7 +588,8 @@ public:
     
     // For testing
     size_t getCacheSize() const { return currentCacheSize; }
-    size_t getCacheEntryCount() const { return cacheMap.size(); }
+    size_t getZombieBytes() const { return zombieBytes; }
+    size_t getCacheEntryCount() const { return cacheIndex.size(); }
     
     friend class CacheFile;
 };
@@ -0,0 +1,167 @@
+// file_type_table.h
+#ifndef FILE_TYPE_TABLE_H
+#define FILE_TYPE_TABLE_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+// Interned file type (extension); index into a FileTypeTable
+typedef uint16_t FileTypeId;
+
+// Built-in file types and their default priorities
+struct BuiltinFileType {
+    const char* extension;
+    float priority;
+};
+
+constexpr BuiltinFileType BUILTIN_FILE_TYPES[] = {
+    {".txt", 0.7f},
+    {".cfg", 0.9f},
+    {".conf", 0.9f},
+    {".ini", 0.9f},
+    {".log", 0.6f},
+    {".json", 0.8f},
+    {".xml", 0.8f},
+    {".cpp", 0.7f},
+    {".h", 0.7f},
+    {".c", 0.7f},
+    {".py", 0.7f},
+    {".jpg", 0.4f},
+    {".png", 0.4f},
+    {".pdf", 0.3f},
+    {".exe", 0.1f},
+    {".so", 0.1f},
+    {".dll", 0.1f}
+};
+
+constexpr size_t BUILTIN_FILE_TYPE_COUNT = sizeof(BUILTIN_FILE_TYPES) / sizeof(BUILTIN_FILE_TYPES[0]);
+
+// Perfect hash over the built-in extensions, found at compile time: a seeded
+// FNV-1a whose top bits pick a slot, with the first seed that gives every
+// built-in its own slot.
+constexpr size_t BUILTIN_TYPE_SLOT_BITS = 6;
+
+constexpr size_t builtinTypeSlot(std::string_view extension, uint32_t seed) {
+    uint32_t hash = seed;
+    for (char c : extension) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash >> (32 - BUILTIN_TYPE_SLOT_BITS);
+}
+
+struct BuiltinTypeHash {
+    uint32_t seed;
+    uint8_t slots[size_t(1) << BUILTIN_TYPE_SLOT_BITS];  // built-in index + 1, or 0
+};
+
+constexpr BuiltinTypeHash makeBuiltinTypeHash() {
+    for (uint32_t seed = 2166136261u; ; seed++) {
+        BuiltinTypeHash table{seed, {}};
+        bool collision = false;
+        for (size_t i = 0; i < BUILTIN_FILE_TYPE_COUNT && !collision; i++) {
+            size_t slot = builtinTypeSlot(BUILTIN_FILE_TYPES[i].extension, seed);
+            collision = table.slots[slot] != 0;
+            table.slots[slot] = static_cast<uint8_t>(i + 1);
+        }
+        if (!collision) {
+            return table;
+        }
+    }
+}
+
+constexpr BuiltinTypeHash BUILTIN_TYPE_HASH = makeBuiltinTypeHash();
+
+// Interns file extensions to small ids and holds each type's priority, so
+// entries store 2 bytes instead of a string and scoring is an array lookup.
+// Id 0 is the empty extension and built-in types have fixed ids after it,
+// resolved through BUILTIN_TYPE_HASH without touching a map; other types are
+// added on first use. Types beyond the id space share OVERFLOW_TYPE, the last
+// id, which keeps the default priority.
+//
+// Not thread-safe; ContentAwareCache uses it under cacheMutex.
+class FileTypeTable {
+public:
+    static constexpr size_t MAX_TYPES = 65536;
+    static constexpr FileTypeId OVERFLOW_TYPE = MAX_TYPES - 1;
+
+    explicit FileTypeTable(float defaultPriority = 0.5f) : defaultPriority(defaultPriority) {
+        names.emplace_back();
+        priorities.push_back(defaultPriority);
+        for (const BuiltinFileType& type : BUILTIN_FILE_TYPES) {
+            names.emplace_back(type.extension);
+            priorities.push_back(type.priority);
+        }
+    }
+
+    // Fixed id of a built-in type, or 0. Usable at compile time:
+    //     constexpr FileTypeId kJson = FileTypeTable::findBuiltin(".json");
+    static constexpr FileTypeId findBuiltin(std::string_view extension) {
+        size_t index = BUILTIN_TYPE_HASH.slots[builtinTypeSlot(extension, BUILTIN_TYPE_HASH.seed)];
+        if (index != 0 && extension == BUILTIN_FILE_TYPES[index - 1].extension) {
+            return static_cast<FileTypeId>(index);
+        }
+        return 0;
+    }
+
+    // Extension of a path as std::filesystem::path::extension() gives it, without allocating
+    static std::string_view extensionOf(std::string_view path) {
+        size_t slash = path.find_last_of('/');
+        std::string_view name = slash == std::string_view::npos ? path : path.substr(slash + 1);
+        size_t dot = name.find_last_of('.');
+        if (dot == std::string_view::npos || dot == 0 || name == "..") {
+            return std::string_view();
+        }
+        return name.substr(dot);
+    }
+
+    // Id for the extension, adding it with the default priority if new
+    FileTypeId intern(std::string_view extension) {
+        if (extension.empty()) {
+            return 0;
+        }
+        if (FileTypeId id = findBuiltin(extension)) {
+            return id;
+        }
+        std::string name(extension);
+        auto it = ids.find(name);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        if (names.size() >= OVERFLOW_TYPE) {
+            if (names.size() == OVERFLOW_TYPE) {
+                names.emplace_back("(other)");
+                priorities.push_back(defaultPriority);
+            }
+            return OVERFLOW_TYPE;
+        }
+        FileTypeId id = static_cast<FileTypeId>(names.size());
+        ids.emplace(name, id);
+        names.push_back(std::move(name));
+        priorities.push_back(defaultPriority);
+        return id;
+    }
+
+    float getPriority(FileTypeId id) const { return priorities[id]; }
+    // Ignored for OVERFLOW_TYPE, whose files are of many different types
+    void setPriority(FileTypeId id, float priority) {
+        if (id != OVERFLOW_TYPE) {
+            priorities[id] = priority;
+        }
+    }
+
+    const std::string& getName(FileTypeId id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+
+private:
+    float defaultPriority;
+    std::unordered_map<std::string, FileTypeId> ids;  // types added at run time
+    std::vector<std::string> names;
+    std::vector<float> priorities;
+};
+
+#endif // FILE_TYPE_TABLE_H
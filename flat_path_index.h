@@ -0,0 +1,213 @@
+// flat_path_index.h
+#ifndef FLAT_PATH_INDEX_H
+#define FLAT_PATH_INDEX_H
+
+#include <memory>
+#include <algorithm>
+#include <string_view>
+#include <functional>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Hash of a path as used by FlatPathIndex; equal to std::hash<std::string>
+inline uint64_t hashPath(std::string_view path) {
+    return std::hash<std::string_view>()(path);
+}
+
+// Open-addressing hash index keyed by file path, laid out like a Swiss table.
+//
+// Every slot has a control byte: EMPTY, DELETED, or 7 bits of the path's hash
+// when full. Slots are probed in aligned groups of 16 whose control bytes are
+// matched in one SSE2 compare, so a lookup reads one control group and, barring
+// a 1-in-128 false match, only the slot it lands on. Slots keep the full 64-bit
+// hash beside the value, and paths are compared only when the hashes agree.
+//
+// Value must be default-constructible, movable and provide path() returning the
+// key it was inserted under. Capacity is a power of two kept at most 7/8 full,
+// counting the tombstones erase() leaves behind.
+template <typename Value>
+class FlatPathIndex {
+public:
+    struct Slot {
+        uint64_t hash;
+        Value value;
+    };
+
+    FlatPathIndex() : capacity(0), count(0), tombstones(0) {}
+
+    FlatPathIndex(const FlatPathIndex&) = delete;
+    FlatPathIndex& operator=(const FlatPathIndex&) = delete;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t getCapacity() const { return capacity; }
+
+    // Slot holding path, or nullptr
+    Slot* find(std::string_view path) { return find(path, hashPath(path)); }
+
+    // Same, with hashPath(path) already computed
+    Slot* find(std::string_view path, uint64_t hash) {
+        if (count == 0) {
+            return nullptr;
+        }
+        int8_t tag = tagOf(hash);
+        size_t groupMask = capacity / GROUP_SIZE - 1;
+        size_t group = (hash >> 7) & groupMask;
+        for (size_t step = 1; ; step++) {
+            const int8_t* groupCtrl = ctrl.get() + group * GROUP_SIZE;
+            for (uint32_t matches = matchTag(groupCtrl, tag); matches; matches &= matches - 1) {
+                Slot& slot = slots[group * GROUP_SIZE + __builtin_ctz(matches)];
+                if (slot.hash == hash && slot.value.path() == path) {
+                    return &slot;
+                }
+            }
+            if (matchEmpty(groupCtrl)) {
+                return nullptr;
+            }
+            // Triangular steps visit every group of a power-of-two table
+            group = (group + step) & groupMask;
+        }
+    }
+
+    // Adds a value for a path that is not in the index yet; hash is hashPath(path)
+    Slot& insert(uint64_t hash, Value value) {
+        if ((count + tombstones + 1) * 8 > capacity * 7) {
+            // Double when live slots fill the table; otherwise just drop tombstones
+            rehash((count + 1) * 16 > capacity * 7 ? std::max(capacity * 2, GROUP_SIZE) : capacity);
+        }
+        size_t index = findFreeSlot(hash);
+        if (ctrl[index] == DELETED) {
+            tombstones--;
+        }
+        ctrl[index] = tagOf(hash);
+        slots[index].hash = hash;
+        slots[index].value = std::move(value);
+        count++;
+        return slots[index];
+    }
+
+    // Removes a slot returned by find() or insert()
+    void erase(Slot* slot) {
+        size_t index = static_cast<size_t>(slot - slots.get());
+        slot->value = Value();
+        // A group that still has an empty slot ends every probe reaching it,
+        // so no other path can depend on this slot having been full
+        if (matchEmpty(ctrl.get() + (index & ~(GROUP_SIZE - 1)))) {
+            ctrl[index] = EMPTY;
+        } else {
+            ctrl[index] = DELETED;
+            tombstones++;
+        }
+        count--;
+    }
+
+    // Removes everything and releases the table
+    void clear() {
+        ctrl.reset();
+        slots.reset();
+        capacity = 0;
+        count = 0;
+        tombstones = 0;
+    }
+
+    // Calls fn(Value&) for every entry, in slot order
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        for (size_t i = 0; i < capacity; i++) {
+            if (ctrl[i] >= 0) {
+                fn(slots[i].value);
+            }
+        }
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t i = 0; i < capacity; i++) {
+            if (ctrl[i] >= 0) {
+                fn(static_cast<const Value&>(slots[i].value));
+            }
+        }
+    }
+
+private:
+    static constexpr size_t GROUP_SIZE = 16;
+    static constexpr int8_t EMPTY = -128;
+    static constexpr int8_t DELETED = -2;
+
+    static int8_t tagOf(uint64_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+    // Bit i set where control byte i equals tag
+    static uint32_t matchTag(const int8_t* group, int8_t tag) {
+#if defined(__SSE2__)
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(tag))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP_SIZE; i++) {
+            mask |= static_cast<uint32_t>(group[i] == tag) << i;
+        }
+        return mask;
+#endif
+    }
+
+    static uint32_t matchEmpty(const int8_t* group) { return matchTag(group, EMPTY); }
+
+    // Bit i set where control byte i is EMPTY or DELETED (both have the sign bit)
+    static uint32_t matchFree(const int8_t* group) {
+#if defined(__SSE2__)
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP_SIZE; i++) {
+            mask |= static_cast<uint32_t>(group[i] < 0) << i;
+        }
+        return mask;
+#endif
+    }
+
+    size_t findFreeSlot(uint64_t hash) const {
+        size_t groupMask = capacity / GROUP_SIZE - 1;
+        size_t group = (hash >> 7) & groupMask;
+        for (size_t step = 1; ; step++) {
+            uint32_t free = matchFree(ctrl.get() + group * GROUP_SIZE);
+            if (free) {
+                return group * GROUP_SIZE + __builtin_ctz(free);
+            }
+            group = (group + step) & groupMask;
+        }
+    }
+
+    void rehash(size_t newCapacity) {
+        std::unique_ptr<int8_t[]> oldCtrl = std::move(ctrl);
+        std::unique_ptr<Slot[]> oldSlots = std::move(slots);
+        size_t oldCapacity = capacity;
+
+        ctrl.reset(new int8_t[newCapacity]);
+        slots.reset(new Slot[newCapacity]);
+        std::fill(ctrl.get(), ctrl.get() + newCapacity, EMPTY);
+        capacity = newCapacity;
+        tombstones = 0;
+
+        for (size_t i = 0; i < oldCapacity; i++) {
+            if (oldCtrl[i] >= 0) {
+                size_t index = findFreeSlot(oldSlots[i].hash);
+                ctrl[index] = oldCtrl[i];
+                slots[index].hash = oldSlots[i].hash;
+                slots[index].value = std::move(oldSlots[i].value);
+            }
+        }
+    }
+
+    std::unique_ptr<int8_t[]> ctrl;  // one control byte per slot
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity;
+    size_t count;
+    size_t tombstones;
+};
+
+#endif // FLAT_PATH_INDEX_H
@@ -0,0 +1,73 @@
+// hot_replicas.h
+#ifndef HOT_REPLICAS_H
+#define HOT_REPLICAS_H
+
+#include "content_aware_cache.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+
+// A thread's read-only copy of a hot entry's handle state: a read handle
+// opened once under cacheMutex, which pins the version being replicated
+struct HotReplica {
+    CacheFile view;
+    std::string path;
+    uint64_t pathHash;
+    uint32_t pendingOpens;  // opens served since they were last folded into the entry
+};
+
+// Per-thread replicas of the entries a thread keeps opening for reading.
+//
+// Once a path has HOT_THRESHOLD read-only hits in a row on its slot, the thread
+// replicates it. Later read-only opens of that path are served from the
+// replica without cacheMutex, and they don't copy the entry's shared_ptr or
+// the cache's weak_ptr. Threads hitting the same hot file then share no cache
+// line that is written. Access stats reach the entry every SYNC_INTERVAL opens.
+// Hit counts go to this set's own counter, which the cache sums for statistics.
+//
+// When a replicated entry gets a new version, is evicted or is cleared, the
+// cache bumps its replica epoch and revokes every thread's replicas of it
+// under cacheMutex, so their pins go at once. An owner announces each replica
+// open in `serving` before checking the epoch, and the cache waits for an open
+// in progress before touching the set; opens that see the new epoch go
+// through the lock instead, which brings the set up to date. After its thread
+// exits, a set is marked orphaned and the cache releases the remaining
+// replicas when it needs the memory. The cache deletes the sets.
+class HotReplicaSet {
+public:
+    static constexpr size_t SLOTS = 16;            // direct-mapped by path hash
+    static constexpr uint32_t HOT_THRESHOLD = 32;  // locked hits before replicating
+    static constexpr uint32_t SYNC_INTERVAL = 64;  // replica opens between stat updates
+
+    struct Candidate {
+        uint64_t pathHash;
+        uint32_t hits;
+    };
+
+    HotReplicaSet(std::thread::id owner, uint64_t epoch)
+        : owner(owner), next(nullptr), orphaned(false), serving(false), epoch(epoch), candidates(), hits(0) {}
+
+    static size_t slotOf(uint64_t pathHash) { return (pathHash >> 32) & (SLOTS - 1); }
+
+    // Owner side: counts a hit served from a replica (single writer, no RMW)
+    void countHit() { hits.store(hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+    size_t getHits() const { return hits.load(std::memory_order_relaxed); }
+
+    const std::thread::id owner;
+    HotReplicaSet* next;  // registry list, immutable once published
+    std::atomic<bool> orphaned;  // owner exited; replicas are reclaimed under cacheMutex
+    std::atomic<bool> serving;   // owner is serving an open from a replica
+
+    uint64_t epoch;  // replica epoch the replicas were made under
+    std::array<std::shared_ptr<HotReplica>, SLOTS> replicas;
+    std::array<Candidate, SLOTS> candidates;
+
+private:
+    std::atomic<size_t> hits;
+};
+
+#endif // HOT_REPLICAS_H
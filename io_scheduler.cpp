@@ -0,0 +1,131 @@
+// io_scheduler.cpp
+#include "io_scheduler.h"
+#include <algorithm>
+
+void TokenBucket::setRate(double perSecond, std::chrono::steady_clock::time_point now) {
+    rate = std::max(0.0, perSecond);
+    // At least one whole unit, so a low IOPS limit still admits single ops
+    burst = std::max(rate * BURST_SECONDS, 1.0);
+    tokens = burst;
+    last = now;
+}
+
+void TokenBucket::refill(std::chrono::steady_clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - last).count();
+    if (elapsed > 0) {
+        tokens = std::min(burst, tokens + elapsed * rate);
+        last = now;
+    }
+}
+
+std::chrono::nanoseconds TokenBucket::delayFor(double amount, std::chrono::steady_clock::time_point now) {
+    if (isUnlimited()) {
+        return std::chrono::nanoseconds(0);
+    }
+    refill(now);
+    double needed = std::min(amount, burst);
+    if (tokens >= needed) {
+        return std::chrono::nanoseconds(0);
+    }
+    double seconds = (needed - tokens) / rate;
+    return std::chrono::nanoseconds(static_cast<int64_t>(seconds * 1e9) + 1);
+}
+
+IoScheduler::Ticket& IoScheduler::Ticket::operator=(Ticket&& other) noexcept {
+    if (this != &other) {
+        release();
+        scheduler = other.scheduler;
+        other.scheduler = nullptr;
+    }
+    return *this;
+}
+
+void IoScheduler::Ticket::release() {
+    if (scheduler) {
+        scheduler->finish();
+        scheduler = nullptr;
+    }
+}
+
+IoScheduler::IoScheduler(size_t maxInFlight)
+    : maxInFlight(std::max<size_t>(maxInFlight, 2)), inFlight(0) {}
+
+void IoScheduler::setLimits(IoClass ioClass, const IoClassLimits& limits) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ClassState& state = classes[static_cast<size_t>(ioClass)];
+    auto now = std::chrono::steady_clock::now();
+    state.limits = limits;
+    state.byteBucket.setRate(limits.bytesPerSecond, now);
+    state.opBucket.setRate(limits.opsPerSecond, now);
+    admitted.notify_all();
+}
+
+IoClassLimits IoScheduler::getLimits(IoClass ioClass) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return classes[static_cast<size_t>(ioClass)].limits;
+}
+
+IoScheduler::Ticket IoScheduler::acquire(IoClass ioClass, size_t bytes) {
+    size_t index = static_cast<size_t>(ioClass);
+    ClassState& state = classes[index];
+    // The last slot is kept for demand I/O
+    size_t slots = ioClass == IoClass::Demand ? maxInFlight : maxInFlight - 1;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    auto start = std::chrono::steady_clock::now();
+    state.waiting++;
+
+    while (true) {
+        bool higherWaiting = false;
+        for (size_t higher = 0; higher < index; higher++) {
+            higherWaiting = higherWaiting || classes[higher].waiting > 0;
+        }
+        if (higherWaiting || inFlight >= slots) {
+            admitted.wait(lock);
+            continue;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        auto delay = std::max(state.byteBucket.delayFor(static_cast<double>(bytes), now),
+                              state.opBucket.delayFor(1, now));
+        if (delay.count() > 0) {
+            // Woken early if limits change or a slot frees up
+            admitted.wait_for(lock, delay);
+            continue;
+        }
+
+        state.byteBucket.take(static_cast<double>(bytes));
+        state.opBucket.take(1);
+        state.waiting--;
+        state.ops++;
+        state.bytes += bytes;
+        state.waitTime += std::chrono::duration_cast<std::chrono::nanoseconds>(now - start);
+        inFlight++;
+        // Lower classes may have been held back only by this request waiting
+        admitted.notify_all();
+        return Ticket(this);
+    }
+}
+
+void IoScheduler::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight--;
+    }
+    admitted.notify_all();
+}
+
+size_t IoScheduler::getOps(IoClass ioClass) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return classes[static_cast<size_t>(ioClass)].ops;
+}
+
+size_t IoScheduler::getBytes(IoClass ioClass) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return classes[static_cast<size_t>(ioClass)].bytes;
+}
+
+std::chrono::nanoseconds IoScheduler::getWaitTime(IoClass ioClass) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return classes[static_cast<size_t>(ioClass)].waitTime;
+}
@@ -0,0 +1,121 @@
+// io_scheduler.h
+#ifndef IO_SCHEDULER_H
+#define IO_SCHEDULER_H
+
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Classes of disk I/O, highest priority first
+enum class IoClass : uint8_t {
+    Demand,     // a caller is waiting: misses, handle flushes, synchronous flush()
+    WriteBack,  // background write-back (flushAsync)
+    Prefetch    // speculative loads (prefetch)
+};
+
+constexpr size_t IO_CLASS_COUNT = 3;
+
+// Rate limits for one class; 0 means unlimited
+struct IoClassLimits {
+    double bytesPerSecond = 0;
+    double opsPerSecond = 0;
+};
+
+// Token bucket holding up to BURST_SECONDS of its rate. A request larger than
+// the burst waits for a full bucket and leaves it in debt, so big transfers
+// are paced rather than refused.
+class TokenBucket {
+public:
+    static constexpr double BURST_SECONDS = 0.1;
+
+    TokenBucket() : rate(0), burst(0), tokens(0) {}
+
+    void setRate(double perSecond, std::chrono::steady_clock::time_point now);
+    bool isUnlimited() const { return rate <= 0; }
+
+    // Time until amount can be taken, zero if it can be taken now
+    std::chrono::nanoseconds delayFor(double amount, std::chrono::steady_clock::time_point now);
+    void take(double amount) { tokens -= amount; }
+
+private:
+    void refill(std::chrono::steady_clock::time_point now);
+
+    double rate;
+    double burst;
+    double tokens;
+    std::chrono::steady_clock::time_point last;
+};
+
+// Admission control between the cache and the disk.
+//
+// Every read or write of file contents first takes a Ticket for its class and
+// size, and holds it while the I/O runs. A request is admitted only when:
+// - no request of a higher class is waiting,
+// - its class's byte and IOPS buckets have tokens,
+// - fewer than maxInFlight requests are running.
+// Background classes may only use maxInFlight - 1 slots. Demand misses are
+// therefore never queued behind write-back or prefetch, however much
+// background work is pending. Demand is unlimited unless limits are set for it.
+class IoScheduler {
+public:
+    static constexpr size_t DEFAULT_MAX_IN_FLIGHT = 4;
+
+    // Releases its slot when destroyed
+    class Ticket {
+    public:
+        Ticket() : scheduler(nullptr) {}
+        Ticket(Ticket&& other) noexcept : scheduler(other.scheduler) { other.scheduler = nullptr; }
+        Ticket& operator=(Ticket&& other) noexcept;
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+        ~Ticket() { release(); }
+
+        void release();
+
+    private:
+        explicit Ticket(IoScheduler* scheduler) : scheduler(scheduler) {}
+
+        IoScheduler* scheduler;
+
+        friend class IoScheduler;
+    };
+
+    explicit IoScheduler(size_t maxInFlight = DEFAULT_MAX_IN_FLIGHT);
+
+    IoScheduler(const IoScheduler&) = delete;
+    IoScheduler& operator=(const IoScheduler&) = delete;
+
+    void setLimits(IoClass ioClass, const IoClassLimits& limits);
+    IoClassLimits getLimits(IoClass ioClass) const;
+
+    // Blocks until an I/O of the given size may start
+    Ticket acquire(IoClass ioClass, size_t bytes);
+
+    // Per-class totals for statistics
+    size_t getOps(IoClass ioClass) const;
+    size_t getBytes(IoClass ioClass) const;
+    std::chrono::nanoseconds getWaitTime(IoClass ioClass) const;
+
+private:
+    struct ClassState {
+        IoClassLimits limits;
+        TokenBucket byteBucket;
+        TokenBucket opBucket;
+        size_t waiting = 0;
+        size_t ops = 0;
+        size_t bytes = 0;
+        std::chrono::nanoseconds waitTime{0};
+    };
+
+    void finish();
+
+    mutable std::mutex mutex;
+    std::condition_variable admitted;
+    ClassState classes[IO_CLASS_COUNT];
+    size_t maxInFlight;
+    size_t inFlight;
+};
+
+#endif // IO_SCHEDULER_H
@@ -0,0 +1,103 @@
+// lru_cache.h
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <string>
+#include <unordered_map>
+#include <list>
+#include <vector>
+#include <fstream>
+
+// Enhanced LRU Cache implementation for comparison
+class LRUCache {
+private:
+    struct CacheItem {
+        std::string filePath;
+        std::vector<char> data;
+    };
+    
+    size_t maxCacheSize;
+    size_t currentCacheSize;
+    std::list<std::string> lruList;
+    std::unordered_map<std::string, std::pair<CacheItem, std::list<std::string>::iterator>> cache;
+    
+    size_t cacheHits;
+    size_t cacheMisses;
+    size_t diskReads;
+    
+public:
+    LRUCache(size_t maxSize) 
+        : maxCacheSize(maxSize), currentCacheSize(0), 
+          cacheHits(0), cacheMisses(0), diskReads(0) {}
+    
+    bool accessFile(const std::string& filePath) {
+        auto it = cache.find(filePath);
+        
+        if (it != cache.end()) {
+            // Cache hit
+            cacheHits++;
+            
+            // Move to front of LRU list
+            lruList.erase(it->second.second);
+            lruList.push_front(filePath);
+            it->second.second = lruList.begin();
+            
+            return true;
+        }
+        
+        // Cache miss
+        cacheMisses++;
+        
+        // Read file
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file) {
+            return false;
+        }
+        
+        size_t fileSize = file.tellg();
+        file.seekg(0, std::ios::beg);
+        
+        // Make room in cache if needed
+        while (currentCacheSize + fileSize > maxCacheSize && !lruList.empty()) {
+            std::string victimPath = lruList.back();
+            currentCacheSize -= cache[victimPath].first.data.size();
+            cache.erase(victimPath);
+            lruList.pop_back();
+        }
+        
+        // Add to cache if it fits
+        if (fileSize <= maxCacheSize) {
+            CacheItem item;
+            item.filePath = filePath;
+            item.data.resize(fileSize);
+            
+            file.read(item.data.data(), fileSize);
+            diskReads++;
+            
+            lruList.push_front(filePath);
+            cache[filePath] = {item, lruList.begin()};
+            currentCacheSize += fileSize;
+        } else {
+            // File too large for cache, just read it
+            diskReads++;
+        }
+        
+        return true;
+    }
+    
+    float getHitRate() const {
+        size_t totalAccesses = cacheHits + cacheMisses;
+        if (totalAccesses == 0) {
+            return 0.0f;
+        }
+        return static_cast<float>(cacheHits) / static_cast<float>(totalAccesses);
+    }
+    
+    size_t getDiskReadCount() const { return diskReads; }
+    size_t getCacheHits() const { return cacheHits; }
+    size_t getCacheMisses() const { return cacheMisses; }
+    size_t getCacheSize() const { return currentCacheSize; }
+    size_t getCacheEntryCount() const { return cache.size(); }
+};
+
+#endif // LRU_CACHE_H
@@ -1,5 +1,6 @@
 // main.cpp
 #include "content_aware_cache.h"
+#include "access_trace.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -13,11 +14,16 @@ void displayHelp() {
     std::cout << "  read <filename>                - Read a file through cache" << std::endl;
     std::cout << "  write <filename> <content>     - Write content to a file through cache" << std::endl;
     std::cout << "  append <filename> <content>    - Append content to a file through cache" << std::endl;
+    std::cout << "  prefetch <filename>...         - Load files into the cache in the background" << std::endl;
     std::cout << "  flush                          - Flush all changes to disk" << std::endl;
     std::cout << "  clear                          - Clear the cache" << std::endl;
     std::cout << "  stats                          - Show cache statistics" << std::endl;
     std::cout << "  resize <size_mb>               - Resize the cache (in MB)" << std::endl;
     std::cout << "  priority <ext> <value>         - Set priority for file type (0.0-1.0)" << std::endl;
+    std::cout << "  revalidate <ext> <max_age_ms> [stale_ms] - Check cached files of a type against disk" << std::endl;
+    std::cout << "  mrc [max_mb] [points]          - Show predicted hit rate by cache size" << std::endl;
+    std::cout << "  trace start <tracefile>        - Record accesses into a binary trace" << std::endl;
+    std::cout << "  trace stop                     - Stop recording and finalize the trace" << std::endl;
     std::cout << "  run <filename>                 - Run the test suite" << std::endl;
     std::cout << "  help                           - Show this help" << std::endl;
     std::cout << "  exit                           - Exit the program" << std::endl;
@@ -106,6 +112,9 @@ int main() {
     // Create the cache with 64MB default size
     auto cache = std::make_shared<ContentAwareCache>(64 * 1024 * 1024);
     
+    // Interactive sessions touch few files, so track every path
+    cache->enableMissRatioCurve(1.0);
+    
     std::cout << "Content-Aware Caching System" << std::endl;
     std::cout << "===========================" << std::endl;
     std::cout << "Type 'help' for a list of commands." << std::endl;
@@ -171,6 +180,16 @@ int main() {
             }
             appendFile(cache, args[1], content);
         }
+        else if (args[0] == "prefetch") {
+            if (args.size() < 2) {
+                std::cout << "Error: Missing filename." << std::endl;
+                continue;
+            }
+            for (size_t i = 1; i < args.size(); i++) {
+                cache->prefetch(args[i]);
+            }
+            std::cout << "Queued " << (args.size() - 1) << " file(s) for prefetch." << std::endl;
+        }
         else if (args[0] == "flush") {
             cache->flush();
             std::cout << "Cache flushed to disk." << std::endl;
@@ -211,6 +230,51 @@ int main() {
                 std::cout << "Error: Invalid priority value." << std::endl;
             }
         }
+        else if (args[0] == "revalidate") {
+            if (args.size() < 3) {
+                std::cout << "Error: Missing extension or maximum age." << std::endl;
+                continue;
+            }
+            try {
+                std::chrono::milliseconds maxAge(std::stol(args[2]));
+                std::chrono::milliseconds stale(args.size() >= 4 ? std::stol(args[3]) : 0);
+                cache->setRevalidation(args[1], maxAge, stale);
+                std::cout << "Revalidating " << args[1] << " files after " << maxAge.count() << " ms, served stale for "
+                          << stale.count() << " ms more." << std::endl;
+            }
+            catch (const std::exception& e) {
+                std::cout << "Error: Invalid age value." << std::endl;
+            }
+        }
+        else if (args[0] == "mrc") {
+            try {
+                float maxMB = args.size() >= 2 ? std::stof(args[1]) : 64.0f;
+                size_t points = args.size() >= 3 ? std::stoul(args[2]) : 8;
+                cache->printHitRateCurve(static_cast<size_t>(maxMB * 1024 * 1024), points);
+            }
+            catch (const std::exception& e) {
+                std::cout << "Error: Invalid size or point count." << std::endl;
+            }
+        }
+        else if (args[0] == "trace") {
+            if (args.size() >= 3 && args[1] == "start") {
+                auto recorder = std::make_shared<TraceRecorder>(args[2]);
+                if (!recorder->isOpen()) {
+                    std::cout << "Error: Could not create trace file '" << args[2] << "'." << std::endl;
+                    continue;
+                }
+                cache->setTraceRecorder(recorder);
+                std::cout << "Recording accesses to '" << args[2] << "'." << std::endl;
+            }
+            else if (args.size() >= 2 && args[1] == "stop") {
+                // Dropping the last reference finalizes the trace file
+                cache->setTraceRecorder(nullptr);
+                std::cout << "Trace recording stopped." << std::endl;
+            }
+            else {
+                std::cout << "Error: Use 'trace start <tracefile>' or 'trace stop'." << std::endl;
+            }
+        }
         else if (args[0] == "run") {
             if (args.size() < 2) {
                 std::cout << "Error: Missing test filename." << std::endl;
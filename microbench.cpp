@@ -0,0 +1,397 @@
+// microbench.cpp
+#include "content_aware_cache.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <list>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+// Counts heap allocations so each benchmark can report allocations per operation
+static size_t allocationCount = 0;
+
+void* operator new(size_t size) {
+    allocationCount++;
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+// Keeps a value or memory side effect alive without emitting extra instructions
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// The cache's index structures, filled without a cache around them so the
+// primitives can be timed on their own
+struct BenchIndex {
+    FileTypeTable fileTypes;
+    FlatPathIndex<IndexedEntry> index;
+    std::list<CacheEntry*> lruList;
+
+    // Metadata-only entry: the size drives the score, the payload stays empty
+    std::shared_ptr<CacheEntry> addEntry(const std::string& path, const std::string& type, size_t fileSize) {
+        auto entry = CacheEntry::create(path, fileTypes.intern(type), fileSize);
+        entry->stats.accessCount = fileSize % 64;
+        entry->priorityScore = contentAwarePriorityScore(fileTypes, *entry, CoarseClock::now());
+
+        lruList.push_front(entry.get());
+        index.insert(hashPath(path), IndexedEntry{entry, lruList.begin()});
+        return entry;
+    }
+};
+
+// Benchmark configuration
+struct MicrobenchOptions {
+    std::vector<size_t> entryCounts = {1000, 100000, 1000000};
+    size_t repetitions = 10;
+    double minRepetitionMs = 20.0;
+    std::string filter;
+    bool json = false;
+};
+
+// Timing samples for one benchmark
+struct BenchResult {
+    std::string name;
+    size_t entries;
+    size_t param;
+    size_t iterations;
+    std::vector<double> samplesNs;  // ns per operation, one per repetition
+    double allocsPerOp;
+
+    double median() const {
+        std::vector<double> sorted = samplesNs;
+        std::sort(sorted.begin(), sorted.end());
+        size_t mid = sorted.size() / 2;
+        return sorted.size() % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2.0;
+    }
+    double min() const { return *std::min_element(samplesNs.begin(), samplesNs.end()); }
+    double mean() const {
+        double sum = 0.0;
+        for (double sample : samplesNs) sum += sample;
+        return sum / samplesNs.size();
+    }
+    double stddev() const {
+        double m = mean();
+        double sum = 0.0;
+        for (double sample : samplesNs) sum += (sample - m) * (sample - m);
+        return samplesNs.size() > 1 ? std::sqrt(sum / (samplesNs.size() - 1)) : 0.0;
+    }
+};
+
+// Calibrates an iteration count that takes at least minRepetitionMs, then times repeated runs of it
+template <typename Fn>
+BenchResult runBenchmark(const std::string& name, size_t entries, size_t param,
+                         const MicrobenchOptions& options, Fn&& fn) {
+    using Clock = std::chrono::steady_clock;
+
+    auto timeIterations = [&](size_t iterations) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            fn(i);
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    };
+
+    size_t iterations = 1;
+    for (;;) {
+        double elapsedNs = timeIterations(iterations);
+        if (elapsedNs >= options.minRepetitionMs * 1e6 || iterations >= (1ULL << 30)) {
+            break;
+        }
+        // Aim just past the target, growing at most 10x per step
+        double scale = elapsedNs > 0.0 ? options.minRepetitionMs * 1e6 * 1.2 / elapsedNs : 10.0;
+        iterations = static_cast<size_t>(iterations * std::min(10.0, std::max(2.0, scale)));
+    }
+
+    BenchResult result{name, entries, param, iterations, {}, 0.0};
+    size_t allocationsBefore = allocationCount;
+    for (size_t rep = 0; rep < options.repetitions; rep++) {
+        result.samplesNs.push_back(timeIterations(iterations) / iterations);
+    }
+    result.allocsPerOp = static_cast<double>(allocationCount - allocationsBefore) /
+                         (static_cast<double>(iterations) * options.repetitions);
+    return result;
+}
+
+bool selected(const MicrobenchOptions& options, const std::string& name) {
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+void printResult(const BenchResult& result, const MicrobenchOptions& options) {
+    if (options.json) {
+        return;
+    }
+    std::cout << std::left << std::setw(28) << result.name << std::right
+              << std::setw(10) << result.entries << std::setw(10) << result.param
+              << std::fixed << std::setprecision(1)
+              << std::setw(14) << result.median() << std::setw(12) << result.min()
+              << std::setw(12) << result.stddev() << std::setw(12) << result.iterations
+              << std::setprecision(2) << std::setw(11) << result.allocsPerOp << std::endl;
+}
+
+void printJson(const std::vector<BenchResult>& results) {
+    std::cout << "[" << std::endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        std::cout << "  {\"name\": \"" << r.name << "\", \"entries\": " << r.entries
+                  << ", \"param\": " << r.param << ", \"iterations\": " << r.iterations
+                  << ", \"repetitions\": " << r.samplesNs.size()
+                  << std::fixed << std::setprecision(3)
+                  << ", \"ns_median\": " << r.median() << ", \"ns_min\": " << r.min()
+                  << ", \"ns_mean\": " << r.mean() << ", \"ns_stddev\": " << r.stddev()
+                  << ", \"allocs_per_op\": " << r.allocsPerOp << "}"
+                  << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    std::cout << "]" << std::endl;
+}
+
+// Benchmarks whose cost depends on how many entries the cache holds
+void benchIndexPrimitives(size_t entryCount, const MicrobenchOptions& options, std::vector<BenchResult>& results) {
+    BenchIndex bench;
+    auto cache = std::make_shared<ContentAwareCache>(SIZE_MAX / 2);
+    const std::vector<std::string> types = {".cfg", ".json", ".log", ".txt", ".dat", ".bin", ".jpg", ".so"};
+
+    std::mt19937 rng(42);
+    std::vector<std::string> paths;
+    std::vector<std::shared_ptr<CacheEntry>> entries;
+    paths.reserve(entryCount);
+    entries.reserve(entryCount);
+    for (size_t i = 0; i < entryCount; i++) {
+        const std::string& type = types[i % types.size()];
+        paths.push_back("bench/file_" + std::to_string(i) + type);
+        entries.push_back(bench.addEntry(paths.back(), type, 512 + rng() % (512 * 1024)));
+        // The cache gets empty files under the same paths
+        cache->insert(paths.back(), nullptr, 0);
+    }
+
+    // Random probe order shared by every benchmark at this size
+    std::vector<size_t> order(4096);
+    for (auto& index : order) {
+        index = rng() % entryCount;
+    }
+    const size_t mask = order.size() - 1;
+
+    if (selected(options, "calculatePriorityScore")) {
+        results.push_back(runBenchmark("calculatePriorityScore", entryCount, 0, options, [&](size_t i) {
+            doNotOptimize(contentAwarePriorityScore(bench.fileTypes, *entries[order[i & mask]], CoarseClock::now()));
+        }));
+        printResult(results.back(), options);
+    }
+
+    if (selected(options, "findEntry")) {
+        // Walks every path in a random order, so at large sizes each probe misses the CPU caches
+        std::vector<size_t> coldOrder(entryCount);
+        for (size_t i = 0; i < entryCount; i++) {
+            coldOrder[i] = i;
+        }
+        std::shuffle(coldOrder.begin(), coldOrder.end(), rng);
+        results.push_back(runBenchmark("findEntry (cold)", entryCount, 0, options, [&](size_t i) {
+            doNotOptimize(bench.index.find(paths[coldOrder[i % entryCount]]) != nullptr);
+        }));
+        printResult(results.back(), options);
+    }
+
+    if (selected(options, "updateLRU")) {
+        results.push_back(runBenchmark("updateLRU", entryCount, 0, options, [&](size_t i) {
+            IndexedEntry& indexed = bench.index.find(paths[order[i & mask]])->value;
+            bench.lruList.splice(bench.lruList.begin(), bench.lruList, indexed.lruPosition);
+        }));
+        printResult(results.back(), options);
+    }
+
+    if (selected(options, "findEntryForEviction")) {
+        results.push_back(runBenchmark("findEntryForEviction", entryCount, 0, options, [&](size_t) {
+            std::string victim = selectEvictionVictim(bench.index)->filePath;
+            doNotOptimize(victim);
+        }));
+        printResult(results.back(), options);
+    }
+
+    if (selected(options, "setFileTypePriority")) {
+        // Rescores the entries of one of the eight types
+        results.push_back(runBenchmark("setFileTypePriority", entryCount, 0, options, [&](size_t i) {
+            cache->setFileTypePriority(".log", (i & 1) ? 0.6f : 0.5f);
+        }));
+        printResult(results.back(), options);
+    }
+
+    if (selected(options, "openFile+closeFile")) {
+        results.push_back(runBenchmark("openFile+closeFile (hit)", entryCount, 0, options, [&](size_t i) {
+            CacheFile* file = cache->openFile(paths[order[i & mask]], "r");
+            doNotOptimize(file);
+            cache->closeFile(file);
+        }));
+        printResult(results.back(), options);
+    }
+
+    if (selected(options, "open+close")) {
+        results.push_back(runBenchmark("open+close handle (hit)", entryCount, 0, options, [&](size_t i) {
+            CacheFile file = cache->open(paths[order[i & mask]], "r");
+            doNotOptimize(file.isOpen());
+        }));
+        printResult(results.back(), options);
+
+        // Same opens with the path hashes computed up front
+        std::vector<PathKey> keys(paths.begin(), paths.end());
+        constexpr uint8_t readMode = parseOpenMode("r");
+        results.push_back(runBenchmark("open+close PathKey (hit)", entryCount, 0, options, [&](size_t i) {
+            CacheFile file = cache->open(keys[order[i & mask]], readMode);
+            doNotOptimize(file.isOpen());
+        }));
+        printResult(results.back(), options);
+    }
+
+    // Nothing to write back: the bench directory does not exist
+    cache->clear();
+}
+
+// CacheFile::read() copy cost by read size
+void benchRead(const MicrobenchOptions& options, std::vector<BenchResult>& results) {
+    if (!selected(options, "CacheFile::read")) {
+        return;
+    }
+
+    const size_t maxRead = 1024 * 1024;
+    auto cache = std::make_shared<ContentAwareCache>(SIZE_MAX / 2);
+    std::vector<char> buffer(maxRead, 'x');
+    cache->insert("bench/read_target.dat", buffer.data(), maxRead);
+
+    CacheFile file = cache->open("bench/read_target.dat", "r");
+    for (size_t readSize = 64; readSize <= maxRead; readSize *= 4) {
+        results.push_back(runBenchmark("CacheFile::read", 1, readSize, options, [&](size_t) {
+            file.seek(0, SEEK_SET);
+            doNotOptimize(file.read(buffer.data(), 1, readSize));
+        }));
+        printResult(results.back(), options);
+    }
+    file.close();
+}
+
+// Small appends to one file: the cost of growing a payload and charging the cache budget
+void benchAppend(const MicrobenchOptions& options, std::vector<BenchResult>& results) {
+    if (!selected(options, "CacheFile::write")) {
+        return;
+    }
+
+    const size_t appendSize = 100;
+    const size_t appendsPerFile = 10000;
+    auto cache = std::make_shared<ContentAwareCache>(SIZE_MAX / 2);
+    cache->insert("bench/append_target.log", nullptr, 0);
+    std::vector<char> record(appendSize, 'a');
+
+    // Warm up first: the first arena page can be slow to get right after the
+    // index benchmarks free their entries, which would throw off calibration
+    CacheFile file = cache->open("bench/append_target.log", "w");
+    file.write(record.data(), 1, appendSize);
+
+    // Start over every appendsPerFile appends, so the file stays ~1MB
+    size_t appends = 0;
+    results.push_back(runBenchmark("CacheFile::write (append)", 1, appendSize, options, [&](size_t) {
+        if (appends++ % appendsPerFile == 0) {
+            file = cache->open("bench/append_target.log", "w");
+        }
+        doNotOptimize(file.write(record.data(), 1, appendSize));
+    }));
+    printResult(results.back(), options);
+    file.close();
+}
+
+void displayUsage() {
+    std::cout << "Usage: microbench [options]" << std::endl;
+    std::cout << "  --entries <list>    Comma-separated cache entry counts (default 1000,100000,1000000)" << std::endl;
+    std::cout << "  --reps <n>          Timed repetitions per benchmark (default 10)" << std::endl;
+    std::cout << "  --min-time <ms>     Minimum duration of one repetition (default 20)" << std::endl;
+    std::cout << "  --filter <text>     Only run benchmarks whose name contains <text>" << std::endl;
+    std::cout << "  --json              Print results as JSON for comparison across commits" << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], MicrobenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--json") {
+            options.json = true;
+            continue;
+        }
+        if (arg == "--help" || i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--entries") {
+            options.entryCounts.clear();
+            size_t start = 0;
+            while (start <= value.size()) {
+                size_t comma = value.find(',', start);
+                std::string item = value.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+                if (!item.empty()) {
+                    options.entryCounts.push_back(std::max<size_t>(1, std::stoul(item)));
+                }
+                if (comma == std::string::npos) break;
+                start = comma + 1;
+            }
+        } else if (arg == "--reps") {
+            options.repetitions = std::max<size_t>(1, std::stoul(value));
+        } else if (arg == "--min-time") {
+            options.minRepetitionMs = std::stod(value);
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else {
+            std::cout << "Error: Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    MicrobenchOptions options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            displayUsage();
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Error: Invalid option value." << std::endl;
+        displayUsage();
+        return 1;
+    }
+
+    if (!options.json) {
+        std::cout << "Content-Aware Cache Microbenchmarks (" << options.repetitions << " repetitions)" << std::endl;
+        std::cout << "sizeof(CacheEntry): " << sizeof(CacheEntry) << " bytes + up to "
+                  << CacheEntry::MAX_INLINE_PAYLOAD << " inline payload bytes" << std::endl;
+        std::cout << std::left << std::setw(28) << "benchmark" << std::right
+                  << std::setw(10) << "entries" << std::setw(10) << "param"
+                  << std::setw(14) << "median ns/op" << std::setw(12) << "min ns/op"
+                  << std::setw(12) << "stddev" << std::setw(12) << "iterations"
+                  << std::setw(11) << "allocs/op" << std::endl;
+    }
+
+    std::vector<BenchResult> results;
+    for (size_t entryCount : options.entryCounts) {
+        benchIndexPrimitives(entryCount, options, results);
+    }
+    benchRead(options, results);
+    benchAppend(options, results);
+
+    if (options.json) {
+        printJson(results);
+    }
+    return 0;
+}
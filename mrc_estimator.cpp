@@ -0,0 +1,156 @@
+// mrc_estimator.cpp
+#include "mrc_estimator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const uint32_t INITIAL_SLOTS = 1024;
+
+int highestBit(uint64_t value) {
+    int bit = 0;
+    while (value >>= 1) {
+        bit++;
+    }
+    return bit;
+}
+
+} // namespace
+
+MissRatioCurveEstimator::MissRatioCurveEstimator(double rate)
+    : samplingRate(std::max(1e-6, std::min(1.0, rate))),
+      threshold(static_cast<uint64_t>(std::ceil(samplingRate * (1ULL << 24)))),
+      nextSlot(1), histogram(BUCKET_COUNT, 0),
+      coldMisses(0), sampledAccesses(0), totalAccesses(0) {
+    tree.assign(INITIAL_SLOTS + 1, 0);
+}
+
+void MissRatioCurveEstimator::treeAdd(uint32_t slot, int64_t delta) {
+    for (size_t i = slot; i < tree.size(); i += i & (~i + 1)) {
+        tree[i] += delta;
+    }
+}
+
+int64_t MissRatioCurveEstimator::treePrefix(uint32_t slot) const {
+    int64_t sum = 0;
+    for (size_t i = slot; i > 0; i -= i & (~i + 1)) {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+void MissRatioCurveEstimator::compact() {
+    // Renumber live objects 1..n in last-access order, leaving at least n free slots
+    std::vector<std::pair<uint32_t, uint64_t>> live;
+    live.reserve(lastAccess.size());
+    for (const auto& pair : lastAccess) {
+        live.emplace_back(pair.second.first, pair.first);
+    }
+    std::sort(live.begin(), live.end());
+
+    size_t capacity = std::max<size_t>(INITIAL_SLOTS, live.size() * 2);
+    tree.assign(capacity + 1, 0);
+
+    uint32_t slot = 1;
+    for (const auto& item : live) {
+        auto& last = lastAccess[item.second];
+        last.first = slot;
+        treeAdd(slot, static_cast<int64_t>(last.second));
+        slot++;
+    }
+    nextSlot = slot;
+}
+
+size_t MissRatioCurveEstimator::bucketFor(uint64_t distance) {
+    const uint64_t subBuckets = 1ULL << SUB_BUCKET_BITS;
+    if (distance < subBuckets) {
+        return static_cast<size_t>(distance);
+    }
+    int msb = highestBit(distance);
+    size_t major = static_cast<size_t>(msb - SUB_BUCKET_BITS + 1);
+    size_t sub = static_cast<size_t>((distance >> (msb - SUB_BUCKET_BITS)) & (subBuckets - 1));
+    return (major << SUB_BUCKET_BITS) | sub;
+}
+
+uint64_t MissRatioCurveEstimator::bucketLowerBound(size_t bucket) {
+    const uint64_t subBuckets = 1ULL << SUB_BUCKET_BITS;
+    size_t major = bucket >> SUB_BUCKET_BITS;
+    uint64_t sub = bucket & (subBuckets - 1);
+    if (major == 0) {
+        return sub;
+    }
+    return (subBuckets + sub) << (major - 1);
+}
+
+void MissRatioCurveEstimator::recordSampledAccess(uint64_t keyHash, uint64_t size) {
+    sampledAccesses++;
+
+    if (nextSlot >= tree.size()) {
+        compact();
+    }
+
+    auto it = lastAccess.find(keyHash);
+    if (it != lastAccess.end()) {
+        // Bytes of distinct sampled objects touched since this key's last access
+        uint32_t lastSlot = it->second.first;
+        int64_t between = treePrefix(nextSlot - 1) - treePrefix(lastSlot);
+        uint64_t distance = static_cast<uint64_t>(between / samplingRate) + size;
+        histogram[std::min(bucketFor(distance), BUCKET_COUNT - 1)]++;
+
+        treeAdd(lastSlot, -static_cast<int64_t>(it->second.second));
+        it->second = {nextSlot, size};
+    } else {
+        coldMisses++;
+        lastAccess.emplace(keyHash, std::make_pair(nextSlot, size));
+    }
+
+    treeAdd(nextSlot, static_cast<int64_t>(size));
+    nextSlot++;
+}
+
+double MissRatioCurveEstimator::predictHitRate(uint64_t cacheBytes) const {
+    // SHARDS_adj: the gap between expected and actual sample counts goes to the first bucket
+    double expected = totalAccesses * samplingRate;
+    double adjustment = expected - static_cast<double>(sampledAccesses);
+    if (expected <= 0.0) {
+        return 0.0;
+    }
+
+    double hits = adjustment;
+    for (size_t b = 0; b < BUCKET_COUNT; b++) {
+        if (histogram[b] == 0) {
+            continue;
+        }
+        uint64_t lower = bucketLowerBound(b);
+        uint64_t upper = bucketLowerBound(b + 1);
+        if (upper <= cacheBytes + 1) {
+            hits += histogram[b];
+        } else if (lower <= cacheBytes) {
+            // Assume distances are spread evenly inside the bucket
+            hits += histogram[b] * static_cast<double>(cacheBytes + 1 - lower) / (upper - lower);
+        } else {
+            break;
+        }
+    }
+
+    return std::max(0.0, std::min(1.0, hits / expected));
+}
+
+std::vector<std::pair<uint64_t, double>> MissRatioCurveEstimator::getCurve(uint64_t maxBytes, size_t points) const {
+    std::vector<std::pair<uint64_t, double>> curve;
+    for (size_t i = 1; i <= points; i++) {
+        uint64_t size = maxBytes * i / points;
+        curve.emplace_back(size, predictHitRate(size));
+    }
+    return curve;
+}
+
+void MissRatioCurveEstimator::reset() {
+    tree.assign(INITIAL_SLOTS + 1, 0);
+    lastAccess.clear();
+    nextSlot = 1;
+    std::fill(histogram.begin(), histogram.end(), 0);
+    coldMisses = 0;
+    sampledAccesses = 0;
+    totalAccesses = 0;
+}
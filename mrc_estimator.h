@@ -0,0 +1,88 @@
+// mrc_estimator.h
+#ifndef MRC_ESTIMATOR_H
+#define MRC_ESTIMATOR_H
+
+#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+// Online miss-ratio-curve estimation with spatially hashed sampling (SHARDS).
+//
+// Only keys whose hash falls below a threshold are tracked, so a 1% sampling
+// rate tracks ~1% of the objects and ~1% of their accesses. For each sampled
+// access the byte reuse distance (bytes of distinct sampled objects touched
+// since the previous access, scaled by 1/rate) is added to a histogram, which
+// yields the predicted LRU hit rate for any cache size.
+//
+// Not thread-safe; callers serialize access (ContentAwareCache feeds it under cacheMutex).
+class MissRatioCurveEstimator {
+private:
+    // Histogram buckets: 16 linear sub-buckets per power of two (~6% resolution)
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr size_t BUCKET_COUNT = 64 << SUB_BUCKET_BITS;
+
+    double samplingRate;
+    uint64_t threshold;
+
+    // Fenwick tree over logical time: slot t holds the size of the object whose last access was t
+    std::vector<int64_t> tree;
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint64_t>> lastAccess;  // key -> (slot, size)
+    uint32_t nextSlot;
+
+    std::vector<uint64_t> histogram;
+    uint64_t coldMisses;
+    uint64_t sampledAccesses;
+    uint64_t totalAccesses;
+
+    void treeAdd(uint32_t slot, int64_t delta);
+    int64_t treePrefix(uint32_t slot) const;
+    void compact();
+
+    void recordSampledAccess(uint64_t keyHash, uint64_t size);
+
+    static size_t bucketFor(uint64_t distance);
+    static uint64_t bucketLowerBound(size_t bucket);
+
+public:
+    explicit MissRatioCurveEstimator(double samplingRate = 0.01);
+
+    // Spatial sampling filter; keyHash should be a well-mixed 64-bit hash
+    bool isSampled(uint64_t keyHash) const {
+        return (keyHash >> 40) < threshold;
+    }
+
+    // Records one access; cheap no-op for keys outside the sample
+    void recordAccess(uint64_t keyHash, uint64_t size) {
+        totalAccesses++;
+        if (isSampled(keyHash)) {
+            recordSampledAccess(keyHash, size);
+        }
+    }
+
+    // Predicted LRU hit rate (0.0-1.0) for a cache of the given size in bytes
+    double predictHitRate(uint64_t cacheBytes) const;
+
+    // Predicted hit rate at evenly spaced sizes up to maxBytes
+    std::vector<std::pair<uint64_t, double>> getCurve(uint64_t maxBytes, size_t points) const;
+
+    double getSamplingRate() const { return samplingRate; }
+    uint64_t getSampledAccesses() const { return sampledAccesses; }
+    uint64_t getTotalAccesses() const { return totalAccesses; }
+    size_t getTrackedObjects() const { return lastAccess.size(); }
+
+    void reset();
+};
+
+// 64-bit finalizer that spreads std::hash output across all bits for sampling
+inline uint64_t mixSampleHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+#endif // MRC_ESTIMATOR_H
@@ -0,0 +1,143 @@
+// numa_topology.cpp
+#include "numa_topology.h"
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+namespace {
+
+#if defined(__linux__)
+// Node mask for mbind; the kernel reads maxnode - 1 bits, so leave a spare word
+struct NodeMask {
+    std::vector<unsigned long> words;
+
+    explicit NodeMask(size_t nodeCount) : words(nodeCount / (8 * sizeof(unsigned long)) + 2, 0) {}
+
+    void set(size_t node) {
+        words[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    }
+    unsigned long maxNode() const { return words.size() * 8 * sizeof(unsigned long); }
+};
+
+bool setPolicy(void* addr, size_t length, int mode, const NodeMask& mask) {
+    return syscall(SYS_mbind, addr, length, mode, mask.words.data(), mask.maxNode(), MPOL_MF_MOVE) == 0;
+}
+#endif
+
+} // namespace
+
+const NumaTopology& NumaTopology::get() {
+    static const NumaTopology topology([] {
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string list;
+        std::getline(online, list);
+        return parseNodeList(list);
+    }());
+    return topology;
+}
+
+std::vector<int> NumaTopology::parseNodeList(const std::string& list) {
+    std::vector<int> nodes;
+    size_t pos = 0;
+    while (pos < list.size() && list[pos] != '\n') {
+        size_t end = list.find_first_of(",\n", pos);
+        std::string range = list.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+        try {
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            if (first < 0 || last < first) {
+                return std::vector<int>();
+            }
+            for (int node = first; node <= last; node++) {
+                nodes.push_back(node);
+            }
+        } catch (const std::exception&) {
+            return std::vector<int>();
+        }
+        if (end == std::string::npos || list[end] == '\n') {
+            break;
+        }
+        pos = end + 1;
+    }
+    return nodes;
+}
+
+NumaTopology::NumaTopology(const std::vector<int>& onlineNodes) : nodeCount(1), onlineNodes(onlineNodes) {
+    if (!this->onlineNodes.empty()) {
+        nodeCount = static_cast<size_t>(*std::max_element(onlineNodes.begin(), onlineNodes.end())) + 1;
+    } else {
+        this->onlineNodes.push_back(0);
+    }
+}
+
+bool NumaTopology::isOnline(int node) const {
+    return std::find(onlineNodes.begin(), onlineNodes.end(), node) != onlineNodes.end();
+}
+
+int NumaTopology::currentNode() const {
+#if defined(__linux__)
+    if (nodeCount > 1) {
+        unsigned cpu;
+        unsigned node;
+        if (getcpu(&cpu, &node) == 0 && node < nodeCount) {
+            return static_cast<int>(node);
+        }
+    }
+#endif
+    return 0;
+}
+
+bool NumaTopology::bindToNode(void* addr, size_t length, int node) const {
+#if defined(__linux__)
+    if (nodeCount > 1 && isOnline(node)) {
+        NodeMask mask(nodeCount);
+        mask.set(static_cast<size_t>(node));
+        // Preferred rather than bound: a full node spills over instead of failing
+        return setPolicy(addr, length, MPOL_PREFERRED, mask);
+    }
+#else
+    (void)addr;
+    (void)length;
+    (void)node;
+#endif
+    return nodeCount == 1;
+}
+
+bool NumaTopology::interleave(void* addr, size_t length) const {
+#if defined(__linux__)
+    if (nodeCount > 1) {
+        // Online nodes only: the kernel rejects a mask naming an offline node
+        NodeMask mask(nodeCount);
+        for (int node : onlineNodes) {
+            mask.set(static_cast<size_t>(node));
+        }
+        return setPolicy(addr, length, MPOL_INTERLEAVE, mask);
+    }
+#else
+    (void)addr;
+    (void)length;
+#endif
+    return nodeCount == 1;
+}
+
+int NumaTopology::nodeOfAddress(const void* addr) const {
+    if (nodeCount == 1) {
+        return 0;
+    }
+#if defined(__linux__)
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0, addr, MPOL_F_NODE | MPOL_F_ADDR) == 0) {
+        return node;
+    }
+#else
+    (void)addr;
+#endif
+    return -1;
+}
@@ -0,0 +1,47 @@
+// numa_topology.h
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// NUMA nodes of the machine, read from sysfs, and page placement through the
+// raw getcpu/mbind/get_mempolicy system calls, so libnuma is not needed.
+//
+// Machines with a single node, or without NUMA support, report node 0 only.
+// Placement calls then do nothing, so callers need no separate fallback path.
+class NumaTopology {
+public:
+    // Topology of this machine, detected on first use
+    static const NumaTopology& get();
+
+    // Parses a sysfs node list such as "0-1,3"; empty if malformed
+    static std::vector<int> parseNodeList(const std::string& list);
+
+    explicit NumaTopology(const std::vector<int>& onlineNodes);
+
+    // One past the highest online node id; at least 1
+    size_t getNodeCount() const { return nodeCount; }
+    bool isMultiNode() const { return nodeCount > 1; }
+    // Online node ids as listed by sysfs; ids can have gaps, as in "0,2"
+    const std::vector<int>& getOnlineNodes() const { return onlineNodes; }
+    bool isOnline(int node) const;
+
+    // Node of the CPU the calling thread is running on (a vDSO call, no syscall)
+    int currentNode() const;
+
+    // Prefers node for the pages of a page-aligned range, moving pages that
+    // were already touched. Returns false if the kernel refused.
+    bool bindToNode(void* addr, size_t length, int node) const;
+    // Spreads the pages of a page-aligned range round-robin over the online nodes
+    bool interleave(void* addr, size_t length) const;
+    // Node holding the page at addr, or -1 if unknown
+    int nodeOfAddress(const void* addr) const;
+
+private:
+    size_t nodeCount;
+    std::vector<int> onlineNodes;
+};
+
+#endif // NUMA_TOPOLOGY_H
@@ -0,0 +1,435 @@
+// payload_arena.cpp
+#include "payload_arena.h"
+#include "content_aware_cache.h"
+#include "numa_topology.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <algorithm>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Header at the start of every PAGE_SIZE-aligned page
+struct PayloadArena::Page {
+    PayloadArena* arena;
+    uint32_t index;       // position in PayloadArena::pages
+    uint32_t used;        // bytes handed out, including this header
+    uint32_t liveBytes;   // bytes of live blocks, including their headers
+    uint32_t liveBlocks;
+    uint16_t node;        // NUMA node the page is bound to
+    bool sparse;          // queued in sparsePages
+};
+
+// Header in front of every block
+struct PayloadArena::BlockHeader {
+    CacheEntry* owner;    // null once freed; unused for large blocks
+    uint32_t size;        // usable bytes following this header
+    uint32_t large;       // block comes from the large region (LargeHeader precedes this)
+};
+
+// Extra header in front of large-region blocks; with the BlockHeader it spans one cache line
+struct PayloadArena::LargeHeader {
+    PayloadArena* arena;
+    size_t offset;        // in region units
+    size_t units;
+    size_t padding[3];
+};
+
+namespace {
+
+constexpr size_t BLOCK_ALIGN = 16;
+
+constexpr size_t alignUp(size_t size) {
+    return (size + BLOCK_ALIGN - 1) & ~(BLOCK_ALIGN - 1);
+}
+
+constexpr size_t REGION_UNIT = 4096;
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+} // namespace
+
+PayloadArena::PayloadArena()
+    : currentPages(NumaTopology::get().getNodeCount(), nullptr),
+      sparePages(NumaTopology::get().getNodeCount(), nullptr), liveBlocks(0), liveBytes(0), released(false),
+      region(nullptr), regionUnits(0), regionUsedUnits(0), regionBacking(REGION_NONE) {}
+
+PayloadArena::~PayloadArena() {
+    for (Page* page : pages) {
+        std::free(page);
+    }
+    for (Page* page : sparePages) {
+        std::free(page);
+    }
+#if defined(__linux__)
+    if (region) {
+        munmap(region, regionUnits * REGION_UNIT);
+    }
+#endif
+}
+
+void PayloadArena::release() {
+    bool destroy;
+    {
+        std::lock_guard<std::mutex> lock(arenaMutex);
+        released = true;
+        destroy = liveBlocks == 0;
+    }
+    if (destroy) {
+        delete this;
+    }
+}
+
+PayloadArena::Page* PayloadArena::newPage(int node) {
+    Page* page = sparePages[node];
+    sparePages[node] = nullptr;
+    if (!page) {
+        page = static_cast<Page*>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE));
+        if (!page) {
+            throw std::bad_alloc();
+        }
+        // Memory the heap already touched is migrated to the node as well
+        NumaTopology::get().bindToNode(page, PAGE_SIZE, node);
+    }
+
+    page->arena = this;
+    page->index = static_cast<uint32_t>(pages.size());
+    page->used = static_cast<uint32_t>(alignUp(sizeof(Page)));
+    page->liveBytes = 0;
+    page->liveBlocks = 0;
+    page->node = static_cast<uint16_t>(node);
+    page->sparse = false;
+    pages.push_back(page);
+    return page;
+}
+
+void PayloadArena::releasePage(Page* page) {
+    // Swap-remove from the page list
+    Page* last = pages.back();
+    pages[page->index] = last;
+    last->index = page->index;
+    pages.pop_back();
+
+    if (page == currentPages[page->node]) {
+        currentPages[page->node] = nullptr;
+    }
+    if (!sparePages[page->node]) {
+        sparePages[page->node] = page;
+    } else {
+        std::free(page);
+    }
+}
+
+char* PayloadArena::allocate(CacheEntry* owner, size_t size, size_t& capacity) {
+    int node = NumaTopology::get().currentNode();
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    return allocateLocked(owner, size, capacity, node);
+}
+
+char* PayloadArena::allocateLocked(CacheEntry* owner, size_t size, size_t& capacity, int node) {
+    size_t blockSize = alignUp(std::max<size_t>(1, std::min(size, MAX_BLOCK)));
+    size_t needed = sizeof(BlockHeader) + blockSize;
+
+    Page*& currentPage = currentPages[node];
+    if (!currentPage || currentPage->used + needed > PAGE_SIZE) {
+        Page* previous = currentPage;
+        currentPage = newPage(node);
+
+        // The old page now only loses blocks; queue or drop it like any other
+        if (previous) {
+            if (previous->liveBlocks == 0) {
+                releasePage(previous);
+            } else if (!previous->sparse && previous->liveBytes * 2 < previous->used) {
+                previous->sparse = true;
+                sparsePages.push_back(previous);
+            }
+        }
+    }
+
+    Page* page = currentPage;
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(reinterpret_cast<char*>(page) + page->used);
+    header->owner = owner;
+    header->size = static_cast<uint32_t>(blockSize);
+    header->large = 0;
+
+    page->used += static_cast<uint32_t>(needed);
+    page->liveBytes += static_cast<uint32_t>(needed);
+    page->liveBlocks++;
+    liveBlocks++;
+    liveBytes += needed;
+
+    capacity = blockSize;
+    return reinterpret_cast<char*>(header + 1);
+}
+
+void PayloadArena::free(char* block) {
+    if (!block) {
+        return;
+    }
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(block) - 1;
+    if (header->large) {
+        LargeHeader* largeHeader = reinterpret_cast<LargeHeader*>(header) - 1;
+        largeHeader->arena->freeLarge(largeHeader);
+        return;
+    }
+    Page* page = reinterpret_cast<Page*>(reinterpret_cast<uintptr_t>(block) & ~(PAGE_SIZE - 1));
+    page->arena->freeBlock(page, header);
+}
+
+void PayloadArena::freeBlock(Page* page, BlockHeader* header) {
+    bool destroy = false;
+    {
+        std::lock_guard<std::mutex> lock(arenaMutex);
+
+        size_t size = sizeof(BlockHeader) + header->size;
+        header->owner = nullptr;
+        page->liveBytes -= static_cast<uint32_t>(size);
+        page->liveBlocks--;
+        liveBlocks--;
+        liveBytes -= size;
+
+        if (released) {
+            // Cache is gone; pages are freed together with the arena
+            destroy = liveBlocks == 0;
+        } else if (page != currentPages[page->node] && !page->sparse) {
+            if (page->liveBlocks == 0) {
+                releasePage(page);
+            } else if (page->liveBytes * 2 < page->used) {
+                page->sparse = true;
+                sparsePages.push_back(page);
+            }
+        }
+    }
+    if (destroy) {
+        delete this;
+    }
+}
+
+size_t PayloadArena::compact() {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+
+    std::vector<Page*> work;
+    work.swap(sparsePages);
+    size_t releasedPages = 0;
+
+    for (Page* page : work) {
+        if (page == currentPages[page->node]) {
+            // Still being filled; look again once it is retired
+            page->sparse = false;
+            continue;
+        }
+
+        // Walk the blocks in address order and move every live, unpinned one
+        char* cursor = reinterpret_cast<char*>(page) + alignUp(sizeof(Page));
+        char* end = reinterpret_cast<char*>(page) + page->used;
+        while (cursor < end && page->liveBlocks > 0) {
+            BlockHeader* header = reinterpret_cast<BlockHeader*>(cursor);
+            cursor += sizeof(BlockHeader) + header->size;
+
+            CacheEntry* owner = header->owner;
+            if (!owner || owner->openHandles > 0) {
+                continue;
+            }
+
+            size_t length = owner->data.size();
+            size_t capacity;
+            char* moved = allocateLocked(owner, length, capacity, page->node);
+            std::memcpy(moved, header + 1, length);
+            owner->data.bytes = moved;
+            owner->data.capacity = capacity;
+
+            size_t size = sizeof(BlockHeader) + header->size;
+            header->owner = nullptr;
+            page->liveBytes -= static_cast<uint32_t>(size);
+            page->liveBlocks--;
+            liveBlocks--;
+            liveBytes -= size;
+        }
+
+        page->sparse = false;
+        if (page->liveBlocks == 0) {
+            releasePage(page);
+            releasedPages++;
+        } else {
+            // Pinned blocks remain; retry on a later eviction
+            page->sparse = true;
+            sparsePages.push_back(page);
+        }
+    }
+
+    return releasedPages;
+}
+
+PayloadArena::RegionBacking PayloadArena::reserveLargeRegion(size_t bytes) {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    if (region || bytes == 0) {
+        return regionBacking;
+    }
+
+#if defined(__linux__)
+    size_t length = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void* mapping = MAP_FAILED;
+    RegionBacking backing = REGION_NONE;
+
+#ifdef MAP_HUGETLB
+    // Needs pages in vm.nr_hugepages. Without MAP_NORESERVE the kernel reserves
+    // them now, so a short pool fails here instead of with SIGBUS on first touch.
+    mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mapping != MAP_FAILED) {
+        backing = REGION_HUGETLB;
+    }
+#endif
+
+    if (mapping == MAP_FAILED) {
+        mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (mapping == MAP_FAILED) {
+            return REGION_NONE;
+        }
+        backing = REGION_NORMAL;
+#ifdef MADV_HUGEPAGE
+        if (madvise(mapping, length, MADV_HUGEPAGE) == 0) {
+            backing = REGION_TRANSPARENT;
+        }
+#endif
+    }
+
+    // Large payloads are read by threads on every node; spread them evenly
+    NumaTopology::get().interleave(mapping, length);
+
+    region = static_cast<char*>(mapping);
+    regionUnits = length / REGION_UNIT;
+    regionBacking = backing;
+    addFreeRange(0, regionUnits);
+#else
+    (void)bytes;
+#endif
+    return regionBacking;
+}
+
+void PayloadArena::addFreeRange(size_t offset, size_t units) {
+    freeByOffset.emplace(offset, units);
+    freeBySize.emplace(units, offset);
+}
+
+void PayloadArena::removeFreeRange(size_t offset, size_t units) {
+    freeByOffset.erase(offset);
+    freeBySize.erase(std::make_pair(units, offset));
+}
+
+char* PayloadArena::allocateLarge(size_t size, size_t& capacity) {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    if (!region) {
+        return nullptr;
+    }
+
+    size_t headerSize = sizeof(LargeHeader) + sizeof(BlockHeader);
+    if (size > UINT32_MAX - headerSize) {
+        return nullptr;  // block sizes are 32-bit; the heap takes larger payloads
+    }
+    size_t units = (size + headerSize + REGION_UNIT - 1) / REGION_UNIT;
+
+    // Best fit: smallest free range that is large enough
+    auto it = freeBySize.lower_bound(std::make_pair(units, static_cast<size_t>(0)));
+    if (it == freeBySize.end()) {
+        return nullptr;
+    }
+    size_t rangeUnits = it->first;
+    size_t offset = it->second;
+    removeFreeRange(offset, rangeUnits);
+    if (rangeUnits > units) {
+        addFreeRange(offset + units, rangeUnits - units);
+    }
+
+    LargeHeader* largeHeader = reinterpret_cast<LargeHeader*>(region + offset * REGION_UNIT);
+    largeHeader->arena = this;
+    largeHeader->offset = offset;
+    largeHeader->units = units;
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(largeHeader + 1);
+    header->owner = nullptr;
+    header->size = static_cast<uint32_t>(std::min<size_t>(units * REGION_UNIT - headerSize, UINT32_MAX));
+    header->large = 1;
+
+    regionUsedUnits += units;
+    liveBlocks++;
+
+    capacity = header->size;
+    return reinterpret_cast<char*>(header + 1);
+}
+
+void PayloadArena::freeLarge(LargeHeader* header) {
+    bool destroy;
+    {
+        std::lock_guard<std::mutex> lock(arenaMutex);
+
+        size_t offset = header->offset;
+        size_t units = header->units;
+        regionUsedUnits -= units;
+        liveBlocks--;
+
+        // Coalesce with the free neighbours on both sides
+        auto next = freeByOffset.find(offset + units);
+        if (next != freeByOffset.end()) {
+            size_t nextUnits = next->second;
+            removeFreeRange(offset + units, nextUnits);
+            units += nextUnits;
+        }
+        auto prev = freeByOffset.lower_bound(offset);
+        if (prev != freeByOffset.begin()) {
+            --prev;
+            if (prev->first + prev->second == offset) {
+                size_t prevOffset = prev->first;
+                size_t prevUnits = prev->second;
+                removeFreeRange(prevOffset, prevUnits);
+                offset = prevOffset;
+                units += prevUnits;
+            }
+        }
+        addFreeRange(offset, units);
+
+        destroy = released && liveBlocks == 0;
+    }
+    if (destroy) {
+        delete this;
+    }
+}
+
+PayloadArena::RegionBacking PayloadArena::getRegionBacking() const {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    return regionBacking;
+}
+
+size_t PayloadArena::getRegionSize() const {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    return regionUnits * REGION_UNIT;
+}
+
+size_t PayloadArena::getRegionUsed() const {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    return regionUsedUnits * REGION_UNIT;
+}
+
+const char* PayloadArena::regionBackingName(RegionBacking backing) {
+    switch (backing) {
+        case REGION_HUGETLB: return "huge pages (MAP_HUGETLB)";
+        case REGION_TRANSPARENT: return "transparent huge pages";
+        case REGION_NORMAL: return "normal pages";
+        default: return "none";
+    }
+}
+
+size_t PayloadArena::getPageCount() const {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    return pages.size();
+}
+
+size_t PayloadArena::getPageCount(int node) const {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    return std::count_if(pages.begin(), pages.end(), [node](const Page* page) { return page->node == node; });
+}
+
+size_t PayloadArena::getLiveBytes() const {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    return liveBytes;
+}
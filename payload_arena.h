@@ -0,0 +1,118 @@
+// payload_arena.h
+#ifndef PAYLOAD_ARENA_H
+#define PAYLOAD_ARENA_H
+
+#include <mutex>
+#include <vector>
+#include <map>
+#include <set>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+class CacheEntry;
+
+// Packs small payloads contiguously in large pages.
+//
+// Blocks are bump-allocated from the current page and record the entry that
+// owns them. Freed blocks leave holes; once a page is less than half live,
+// compact() moves its blocks into the current page (fixing up the owners'
+// payload pointers) and returns the emptied page. Blocks of entries with open
+// handles are never moved, since readers use the payload without the lock, and
+// neither are blocks without an owner (drafts that open handles write into).
+//
+// On machines with several NUMA nodes every node has its own current page,
+// bound to that node. A block goes to the page of the allocating thread's node,
+// so a payload is read locally by the threads that load it. Compaction keeps
+// each block on the node it was placed on.
+//
+// allocate() and compact() run under cacheMutex. free() can also run after the
+// cache is gone, when the last handle to an evicted entry closes, so the arena
+// deletes itself once the cache has released it and no blocks remain.
+//
+// Optionally, larger payloads come from one pre-reserved region backed by huge
+// pages (reserveLargeRegion), which cuts TLB misses when copying out of
+// multi-GB caches. The region is carved best-fit in 4KB units with coalescing
+// frees; when it is full or absent, payloads fall back to the heap. Its pages
+// are interleaved over the NUMA nodes.
+class PayloadArena {
+public:
+    static constexpr size_t PAGE_SIZE = 256 * 1024;
+    static constexpr size_t MAX_BLOCK = 4096;  // largest payload kept in the arena
+
+    // unique_ptr deleter for the owning cache
+    struct Releaser {
+        void operator()(PayloadArena* arena) const { arena->release(); }
+    };
+
+    PayloadArena();
+
+    // Block of at least size bytes (size <= MAX_BLOCK); capacity receives its usable size
+    char* allocate(CacheEntry* owner, size_t size, size_t& capacity);
+
+    // Releases a block returned by allocate()
+    static void free(char* block);
+
+    // Moves movable blocks out of sparse pages; returns the number of pages released
+    size_t compact();
+
+    // How the large-payload region is backed
+    enum RegionBacking {
+        REGION_NONE,        // not reserved, or reservation failed
+        REGION_HUGETLB,     // explicit huge pages (MAP_HUGETLB)
+        REGION_TRANSPARENT, // normal mapping with madvise(MADV_HUGEPAGE)
+        REGION_NORMAL       // normal pages; huge pages unavailable
+    };
+
+    // Reserves address space for large payloads, trying MAP_HUGETLB, then
+    // transparent huge pages, then plain pages. Memory is committed on first touch.
+    // Can only be done once; returns the backing obtained.
+    RegionBacking reserveLargeRegion(size_t bytes);
+
+    // Block of at least size bytes from the large region, or nullptr if it is
+    // absent or full (the caller then uses the heap)
+    char* allocateLarge(size_t size, size_t& capacity);
+
+    // Page and byte counts for statistics
+    size_t getPageCount() const;
+    size_t getPageCount(int node) const;
+    size_t getLiveBytes() const;
+    RegionBacking getRegionBacking() const;
+    size_t getRegionSize() const;
+    size_t getRegionUsed() const;
+    static const char* regionBackingName(RegionBacking backing);
+
+private:
+    struct Page;
+    struct BlockHeader;
+    struct LargeHeader;
+
+    ~PayloadArena();
+    void release();
+    void freeBlock(Page* page, BlockHeader* header);
+    char* allocateLocked(CacheEntry* owner, size_t size, size_t& capacity, int node);
+    Page* newPage(int node);
+    void releasePage(Page* page);
+    void freeLarge(LargeHeader* header);
+    void addFreeRange(size_t offset, size_t units);
+    void removeFreeRange(size_t offset, size_t units);
+
+    mutable std::mutex arenaMutex;
+    std::vector<Page*> pages;        // every page in use, indexed by Page::index
+    std::vector<Page*> sparsePages;  // pages queued for compaction
+    std::vector<Page*> currentPages; // page being filled, per NUMA node
+    std::vector<Page*> sparePages;   // one emptied page per node kept to avoid churn
+    size_t liveBlocks;
+    size_t liveBytes;
+    bool released;
+
+    // Large-payload region, in REGION_UNIT units
+    char* region;
+    size_t regionUnits;
+    size_t regionUsedUnits;
+    RegionBacking regionBacking;
+    std::map<size_t, size_t> freeByOffset;        // offset -> length
+    std::set<std::pair<size_t, size_t>> freeBySize;  // (length, offset), for best fit
+};
+
+#endif // PAYLOAD_ARENA_H
@@ -0,0 +1,437 @@
+// replay_trace.cpp
+#include "content_aware_cache.h"
+#include "access_trace.h"
+#include "lru_cache.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <algorithm>
+#include <unordered_map>
+
+// Replay configuration
+struct ReplayOptions {
+    std::string tracePath;
+    std::string policy = "content";
+    size_t cacheSize = 64 * 1024 * 1024;
+    size_t threads = 1;
+    bool originalTiming = false;
+    std::string materializeDir;
+    std::vector<std::pair<std::string, float>> priorities;
+};
+
+// An open file during replay
+struct ReplayHandle {
+    CacheFile* file = nullptr;
+    bool hit = false;
+};
+
+// Cache under test
+class ReplayTarget {
+public:
+    virtual ~ReplayTarget() = default;
+    virtual bool open(const std::string& path, const std::string& mode, ReplayHandle& handle) = 0;
+    virtual void read(ReplayHandle& handle, uint64_t offset, uint32_t length, std::vector<char>& scratch) = 0;
+    virtual void write(ReplayHandle& handle, uint64_t offset, uint32_t length, std::vector<char>& scratch) = 0;
+    virtual void close(ReplayHandle& handle) = 0;
+    virtual void printStats() = 0;
+};
+
+class ContentAwareTarget : public ReplayTarget {
+private:
+    std::shared_ptr<ContentAwareCache> cache;
+
+public:
+    ContentAwareTarget(const ReplayOptions& options)
+        : cache(std::make_shared<ContentAwareCache>(options.cacheSize)) {
+        for (const auto& priority : options.priorities) {
+            cache->setFileTypePriority(priority.first, priority.second);
+        }
+    }
+
+    bool open(const std::string& path, const std::string& mode, ReplayHandle& handle) override {
+        handle.file = cache->openFile(path, mode);
+        handle.hit = handle.file && handle.file->wasCacheHit();
+        return handle.file != nullptr;
+    }
+
+    void read(ReplayHandle& handle, uint64_t offset, uint32_t length, std::vector<char>& scratch) override {
+        if (scratch.size() < length) {
+            scratch.resize(length);
+        }
+        handle.file->seek(static_cast<long>(offset), SEEK_SET);
+        handle.file->read(scratch.data(), 1, length);
+    }
+
+    void write(ReplayHandle& handle, uint64_t offset, uint32_t length, std::vector<char>& scratch) override {
+        if (scratch.size() < length) {
+            scratch.resize(length);
+        }
+        handle.file->seek(static_cast<long>(offset), SEEK_SET);
+        handle.file->write(scratch.data(), 1, length);
+    }
+
+    void close(ReplayHandle& handle) override {
+        cache->closeFile(handle.file);
+        handle.file = nullptr;
+    }
+
+    void printStats() override {
+        cache->printStats();
+    }
+};
+
+class LRUTarget : public ReplayTarget {
+private:
+    LRUCache cache;
+    std::mutex lruMutex;  // LRUCache is not thread-safe
+
+public:
+    LRUTarget(const ReplayOptions& options) : cache(options.cacheSize) {}
+
+    bool open(const std::string& path, const std::string&, ReplayHandle& handle) override {
+        std::lock_guard<std::mutex> lock(lruMutex);
+        size_t hitsBefore = cache.getCacheHits();
+        bool ok = cache.accessFile(path);
+        handle.hit = cache.getCacheHits() != hitsBefore;
+        return ok;
+    }
+
+    // LRUCache only models whole-file accesses; reads and writes are served from the cached copy
+    void read(ReplayHandle&, uint64_t, uint32_t, std::vector<char>&) override {}
+    void write(ReplayHandle&, uint64_t, uint32_t, std::vector<char>&) override {}
+    void close(ReplayHandle&) override {}
+
+    void printStats() override {
+        std::lock_guard<std::mutex> lock(lruMutex);
+        std::cout << "LRU Statistics:" << std::endl;
+        std::cout << "  Cache Size: " << cache.getCacheSize() << " bytes" << std::endl;
+        std::cout << "  Cache Entries: " << cache.getCacheEntryCount() << std::endl;
+        std::cout << "  Cache Hits: " << cache.getCacheHits() << std::endl;
+        std::cout << "  Cache Misses: " << cache.getCacheMisses() << std::endl;
+        std::cout << "  Disk Reads: " << cache.getDiskReadCount() << std::endl;
+    }
+};
+
+// Per-worker results
+struct ReplayCounters {
+    size_t opens = 0;
+    size_t failedOpens = 0;
+    size_t hits = 0;
+    uint64_t bytesRead = 0;
+    uint64_t bytesReadFromHits = 0;
+    size_t skippedWrites = 0;
+    std::vector<uint64_t> openLatencyNs;
+    std::vector<uint64_t> readLatencyNs;
+    std::vector<uint64_t> closeLatencyNs;
+};
+
+size_t parseSize(const std::string& text) {
+    size_t multiplier = 1;
+    std::string digits = text;
+    if (!digits.empty()) {
+        switch (digits.back()) {
+            case 'K': case 'k': multiplier = 1024; break;
+            case 'M': case 'm': multiplier = 1024 * 1024; break;
+            case 'G': case 'g': multiplier = 1024 * 1024 * 1024; break;
+            default: break;
+        }
+        if (multiplier != 1) {
+            digits.pop_back();
+        }
+    }
+    return static_cast<size_t>(std::stod(digits) * multiplier);
+}
+
+uint64_t percentile(std::vector<uint64_t>& samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(p * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+void printLatency(const std::string& name, std::vector<uint64_t>& samples) {
+    if (samples.empty()) {
+        return;
+    }
+    std::cout << "  " << name << " latency (ns): p50=" << percentile(samples, 0.50)
+              << " p90=" << percentile(samples, 0.90)
+              << " p99=" << percentile(samples, 0.99)
+              << " max=" << percentile(samples, 1.0)
+              << " (" << samples.size() << " ops)" << std::endl;
+}
+
+// Creates stand-in files sized from the trace so it can be replayed away from the original machine
+std::vector<std::string> materializePaths(const std::vector<std::string>& paths,
+                                          const std::vector<TraceRecord>& records,
+                                          const std::string& dir) {
+    std::vector<uint64_t> sizes(paths.size(), 0);
+    for (const auto& rec : records) {
+        if (rec.pathId >= sizes.size()) {
+            continue;
+        }
+        uint64_t extent = (rec.op == TraceOp::Open) ? rec.length : rec.offset + rec.length;
+        if (rec.op != TraceOp::Close) {
+            sizes[rec.pathId] = std::max(sizes[rec.pathId], extent);
+        }
+    }
+
+    fs::create_directories(dir);
+    std::vector<std::string> mapped;
+    mapped.reserve(paths.size());
+    std::vector<char> fill(64 * 1024, 'A');
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        std::string filePath = dir + "/path_" + std::to_string(i) + fs::path(paths[i]).extension().string();
+        std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+        uint64_t remaining = sizes[i];
+        while (remaining > 0) {
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(remaining, fill.size()));
+            file.write(fill.data(), chunk);
+            remaining -= chunk;
+        }
+        mapped.push_back(filePath);
+    }
+
+    return mapped;
+}
+
+void replayWorker(ReplayTarget& target, const std::vector<TraceRecord>& records,
+                  const std::vector<std::string>& paths, const ReplayOptions& options,
+                  std::chrono::steady_clock::time_point startTime, uint64_t baseTimestamp,
+                  ReplayCounters& counters) {
+    std::unordered_map<uint32_t, std::vector<ReplayHandle>> openHandles;
+    std::vector<char> scratch;
+    bool allowWrites = !options.materializeDir.empty();
+
+    for (const auto& rec : records) {
+        if (rec.pathId >= paths.size()) {
+            continue;
+        }
+
+        if (options.originalTiming) {
+            std::this_thread::sleep_until(startTime + std::chrono::nanoseconds(rec.timestampNs - baseTimestamp));
+        }
+
+        auto opStart = std::chrono::steady_clock::now();
+
+        switch (rec.op) {
+            case TraceOp::Open: {
+                uint8_t mode = rec.mode;
+                if (!allowWrites) {
+                    // Never modify the original files: read-only handles leave
+                    // nothing dirty, so the cache writes nothing back either
+                    mode = TRACE_MODE_READ;
+                }
+                ReplayHandle handle;
+                counters.opens++;
+                if (target.open(paths[rec.pathId], decodeTraceMode(mode), handle)) {
+                    counters.hits += handle.hit ? 1 : 0;
+                    openHandles[rec.pathId].push_back(handle);
+                } else {
+                    counters.failedOpens++;
+                    continue;
+                }
+                counters.openLatencyNs.push_back(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - opStart).count()));
+                break;
+            }
+            case TraceOp::Read: {
+                auto it = openHandles.find(rec.pathId);
+                if (it == openHandles.end() || it->second.empty()) {
+                    continue;
+                }
+                ReplayHandle& handle = it->second.back();
+                target.read(handle, rec.offset, rec.length, scratch);
+                counters.bytesRead += rec.length;
+                counters.bytesReadFromHits += handle.hit ? rec.length : 0;
+                counters.readLatencyNs.push_back(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - opStart).count()));
+                break;
+            }
+            case TraceOp::Write: {
+                auto it = openHandles.find(rec.pathId);
+                if (it == openHandles.end() || it->second.empty()) {
+                    continue;
+                }
+                if (!allowWrites) {
+                    counters.skippedWrites++;
+                    continue;
+                }
+                target.write(it->second.back(), rec.offset, rec.length, scratch);
+                break;
+            }
+            case TraceOp::Close: {
+                auto it = openHandles.find(rec.pathId);
+                if (it == openHandles.end() || it->second.empty()) {
+                    continue;
+                }
+                target.close(it->second.back());
+                it->second.pop_back();
+                counters.closeLatencyNs.push_back(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - opStart).count()));
+                break;
+            }
+        }
+    }
+
+    // Close anything the trace left open
+    for (auto& pair : openHandles) {
+        for (auto& handle : pair.second) {
+            target.close(handle);
+        }
+    }
+}
+
+void displayUsage() {
+    std::cout << "Usage: replay_trace <trace-file> [options]" << std::endl;
+    std::cout << "  --policy content|lru       Cache implementation to replay against (default content)" << std::endl;
+    std::cout << "  --cache-size <size>        Cache size in bytes, K/M/G suffixes allowed (default 64M)" << std::endl;
+    std::cout << "  --threads <n>              Worker threads; trace threads are mapped round-robin (default 1)" << std::endl;
+    std::cout << "  --timing original|fast     Honour recorded timestamps or run as fast as possible (default fast)" << std::endl;
+    std::cout << "  --priority <ext>=<value>   File type priority for the content-aware cache (repeatable)" << std::endl;
+    std::cout << "  --materialize <dir>        Replay against generated stand-in files in <dir>; enables writes" << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], ReplayOptions& options) {
+    if (argc < 2) {
+        return false;
+    }
+    options.tracePath = argv[1];
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cout << "Error: Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--policy") {
+            options.policy = value;
+        } else if (arg == "--cache-size") {
+            options.cacheSize = parseSize(value);
+        } else if (arg == "--threads") {
+            options.threads = std::max<size_t>(1, std::stoul(value));
+        } else if (arg == "--timing") {
+            options.originalTiming = (value == "original");
+        } else if (arg == "--priority") {
+            size_t eq = value.find('=');
+            if (eq == std::string::npos) {
+                std::cout << "Error: Priority must be <ext>=<value>" << std::endl;
+                return false;
+            }
+            options.priorities.emplace_back(value.substr(0, eq), std::stof(value.substr(eq + 1)));
+        } else if (arg == "--materialize") {
+            options.materializeDir = value;
+        } else {
+            std::cout << "Error: Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (options.policy != "content" && options.policy != "lru") {
+        std::cout << "Error: Unknown policy " << options.policy << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    ReplayOptions options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            displayUsage();
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Error: Invalid option value." << std::endl;
+        displayUsage();
+        return 1;
+    }
+
+    TraceReader reader;
+    if (!reader.open(options.tracePath)) {
+        std::cout << "Error: Could not read trace '" << options.tracePath << "'." << std::endl;
+        return 1;
+    }
+
+    std::vector<TraceRecord> records = reader.readAll();
+    std::vector<std::string> paths = reader.getPaths();
+    std::cout << "Loaded " << records.size() << " records over " << paths.size() << " paths." << std::endl;
+
+    if (!options.materializeDir.empty()) {
+        paths = materializePaths(paths, records, options.materializeDir);
+        std::cout << "Materialized stand-in files in '" << options.materializeDir << "'." << std::endl;
+    }
+
+    // Partition records by recorded thread, preserving per-thread order
+    std::vector<std::vector<TraceRecord>> partitions(options.threads);
+    for (const auto& rec : records) {
+        partitions[rec.threadId % options.threads].push_back(rec);
+    }
+    uint64_t baseTimestamp = records.empty() ? 0 : records.front().timestampNs;
+
+    std::unique_ptr<ReplayTarget> target;
+    if (options.policy == "lru") {
+        target.reset(new LRUTarget(options));
+    } else {
+        target.reset(new ContentAwareTarget(options));
+    }
+
+    std::vector<ReplayCounters> counters(options.threads);
+    std::vector<std::thread> workers;
+
+    auto startTime = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < options.threads; t++) {
+        workers.emplace_back(replayWorker, std::ref(*target), std::cref(partitions[t]), std::cref(paths),
+                             std::cref(options), startTime, baseTimestamp, std::ref(counters[t]));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto endTime = std::chrono::steady_clock::now();
+
+    // Merge per-worker results
+    ReplayCounters total;
+    for (auto& c : counters) {
+        total.opens += c.opens;
+        total.failedOpens += c.failedOpens;
+        total.hits += c.hits;
+        total.bytesRead += c.bytesRead;
+        total.bytesReadFromHits += c.bytesReadFromHits;
+        total.skippedWrites += c.skippedWrites;
+        total.openLatencyNs.insert(total.openLatencyNs.end(), c.openLatencyNs.begin(), c.openLatencyNs.end());
+        total.readLatencyNs.insert(total.readLatencyNs.end(), c.readLatencyNs.begin(), c.readLatencyNs.end());
+        total.closeLatencyNs.insert(total.closeLatencyNs.end(), c.closeLatencyNs.begin(), c.closeLatencyNs.end());
+    }
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+    size_t successfulOpens = total.opens - total.failedOpens;
+
+    std::cout << "Replay Results (" << options.policy << ", " << options.threads << " thread(s), "
+              << (options.originalTiming ? "original" : "fast") << " timing):" << std::endl;
+    std::cout << "  Opens: " << total.opens << " (" << total.failedOpens << " failed)" << std::endl;
+    std::cout << "  Hit Rate: " << (successfulOpens ? 100.0 * total.hits / successfulOpens : 0.0) << "%" << std::endl;
+    std::cout << "  Byte Hit Rate: "
+              << (total.bytesRead ? 100.0 * total.bytesReadFromHits / total.bytesRead : 0.0) << "%" << std::endl;
+    std::cout << "  Bytes Read: " << total.bytesRead << std::endl;
+    if (total.skippedWrites > 0) {
+        std::cout << "  Skipped Writes: " << total.skippedWrites << " (use --materialize to replay writes)" << std::endl;
+    }
+    printLatency("Open", total.openLatencyNs);
+    printLatency("Read", total.readLatencyNs);
+    printLatency("Close", total.closeLatencyNs);
+    std::cout << "  Execution Time: " << duration.count() << "ms" << std::endl;
+
+    target->printStats();
+
+    return 0;
+}
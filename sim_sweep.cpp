@@ -0,0 +1,280 @@
+// sim_sweep.cpp
+#include "cache_simulator.h"
+#include "content_aware_cache.h"
+#include "workload_generator.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cmath>
+
+// Sweep configuration
+struct SweepOptions {
+    std::string tracePath;
+    size_t syntheticObjects = 1000;
+    size_t accesses = 1000000;
+    unsigned seed = 42;
+    std::string workload = "realistic";
+    double alpha = 0.9;
+    size_t hotSetSize = 0;
+    size_t interval = 0;
+    std::vector<std::string> policies = simPolicyNames();
+    size_t sizeCount = 50;
+    uint64_t minSize = 0;
+    uint64_t maxSize = 0;
+    size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+    bool csv = false;
+    std::vector<std::pair<std::string, float>> priorities;
+};
+
+uint64_t parseSize(const std::string& text) {
+    uint64_t multiplier = 1;
+    std::string digits = text;
+    if (!digits.empty()) {
+        switch (digits.back()) {
+            case 'K': case 'k': multiplier = 1024; break;
+            case 'M': case 'm': multiplier = 1024 * 1024; break;
+            case 'G': case 'g': multiplier = 1024 * 1024 * 1024; break;
+            default: break;
+        }
+        if (multiplier != 1) {
+            digits.pop_back();
+        }
+    }
+    return static_cast<uint64_t>(std::stod(digits) * multiplier);
+}
+
+// Builds a metadata-only version of the test_cache data set and one of the seeded workloads
+void buildSyntheticTrace(const SweepOptions& options, SimTrace& trace) {
+    std::mt19937 rng(options.seed);
+    std::vector<TestFileTypeInfo> fileTypes = defaultTestFileTypes();
+
+    std::vector<std::string> files;
+    for (size_t i = 0; i < options.syntheticObjects; i++) {
+        const TestFileTypeInfo& typeInfo = fileTypes[i % fileTypes.size()];
+        std::uniform_int_distribution<size_t> sizeDist(typeInfo.minSize, typeInfo.maxSize);
+        files.push_back("sim/file_" + std::to_string(i) + typeInfo.extension);
+        trace.addObject(files.back(), sizeDist(rng));
+    }
+
+    WorkloadGenerator workloadGen(files, options.seed);
+    size_t hotSetSize = options.hotSetSize ? options.hotSetSize : std::max<size_t>(1, files.size() / 10);
+    size_t interval = options.interval ? options.interval : std::max<size_t>(1, options.accesses / 20);
+
+    std::vector<size_t> indices;
+    if (options.workload == "zipf") {
+        indices = workloadGen.generateZipfWorkload(options.accesses, options.alpha);
+    } else if (options.workload == "hotshift") {
+        indices = workloadGen.generateHotSetShiftWorkload(options.accesses, hotSetSize, interval, options.alpha);
+    } else if (options.workload == "scan") {
+        indices = workloadGen.generateScanWithHotSetWorkload(options.accesses, hotSetSize, interval, options.alpha);
+    } else if (options.workload == "loop") {
+        indices = workloadGen.generateLoopWorkload(options.accesses, files.size());
+    }
+
+    if (!indices.empty()) {
+        trace.accesses.assign(indices.begin(), indices.end());
+        return;
+    }
+
+    std::vector<std::string> workload = workloadGen.generateRealisticWorkload(options.accesses);
+
+    std::unordered_map<std::string, uint32_t> ids;
+    for (uint32_t i = 0; i < files.size(); i++) {
+        ids.emplace(files[i], i);
+    }
+    trace.accesses.reserve(workload.size());
+    for (const auto& path : workload) {
+        trace.accesses.push_back(ids[path]);
+    }
+}
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+void displayUsage() {
+    std::cout << "Usage: sim_sweep [options]" << std::endl;
+    std::cout << "  --trace <file>             Simulate the opens recorded in an access trace" << std::endl;
+    std::cout << "  --synthetic <objects>      Simulate a generated data set (default 1000 objects)" << std::endl;
+    std::cout << "  --accesses <n>             Accesses in the generated workload (default 1000000)" << std::endl;
+    std::cout << "  --seed <n>                 Seed for the generated data set and workload (default 42)" << std::endl;
+    std::cout << "  --workload <name>          realistic, zipf, hotshift, scan or loop (default realistic)" << std::endl;
+    std::cout << "  --alpha <a>                Zipf exponent for zipf/hotshift/scan (default 0.9)" << std::endl;
+    std::cout << "  --hot-set <n>              Hot set size for hotshift/scan (default 10% of objects)" << std::endl;
+    std::cout << "  --interval <n>             Accesses between hot-set shifts or scans (default 5% of accesses)" << std::endl;
+    std::cout << "  --policies <list>          Comma-separated subset of lru,fifo,lfu,gdsf,content" << std::endl;
+    std::cout << "  --sizes <n>                Number of cache sizes, log-spaced (default 50)" << std::endl;
+    std::cout << "  --min-size <size>          Smallest cache size (default 1% of the data set)" << std::endl;
+    std::cout << "  --max-size <size>          Largest cache size (default the whole data set)" << std::endl;
+    std::cout << "  --priority <ext>=<value>   File type priority for the content-aware policy (repeatable)" << std::endl;
+    std::cout << "  --jobs <n>                 Simulations run in parallel (default: hardware threads)" << std::endl;
+    std::cout << "  --csv                      Print one CSV row per run" << std::endl;
+    std::cout << "Each job simulates about 50M accesses per second: 2M accesses x 5 policies x 10 sizes" << std::endl;
+    std::cout << "take about 2s on one core." << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], SweepOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--csv") {
+            options.csv = true;
+            continue;
+        }
+        if (arg == "--help" || i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--trace") {
+            options.tracePath = value;
+        } else if (arg == "--synthetic") {
+            options.syntheticObjects = std::stoul(value);
+        } else if (arg == "--accesses") {
+            options.accesses = std::stoul(value);
+        } else if (arg == "--seed") {
+            options.seed = static_cast<unsigned>(std::stoul(value));
+        } else if (arg == "--workload") {
+            options.workload = value;
+        } else if (arg == "--alpha") {
+            options.alpha = std::stod(value);
+        } else if (arg == "--hot-set") {
+            options.hotSetSize = std::stoul(value);
+        } else if (arg == "--interval") {
+            options.interval = std::stoul(value);
+        } else if (arg == "--policies") {
+            options.policies = splitList(value);
+        } else if (arg == "--sizes") {
+            options.sizeCount = std::max<size_t>(1, std::stoul(value));
+        } else if (arg == "--min-size") {
+            options.minSize = parseSize(value);
+        } else if (arg == "--max-size") {
+            options.maxSize = parseSize(value);
+        } else if (arg == "--jobs") {
+            options.jobs = std::max<size_t>(1, std::stoul(value));
+        } else if (arg == "--priority") {
+            size_t eq = value.find('=');
+            if (eq == std::string::npos) {
+                return false;
+            }
+            options.priorities.emplace_back(value.substr(0, eq), std::stof(value.substr(eq + 1)));
+        } else {
+            std::cout << "Error: Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (options.workload != "realistic" && options.workload != "zipf" && options.workload != "hotshift" &&
+        options.workload != "scan" && options.workload != "loop") {
+        std::cout << "Error: Unknown workload " << options.workload << std::endl;
+        return false;
+    }
+    for (const auto& policy : options.policies) {
+        if (!createSimPolicy(policy, 0, 0, {})) {
+            std::cout << "Error: Unknown policy " << policy << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    SweepOptions options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            displayUsage();
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Error: Invalid option value." << std::endl;
+        displayUsage();
+        return 1;
+    }
+
+    SimTrace trace;
+    auto priorities = ContentAwareCache::defaultFileTypePriorities();
+
+    if (!options.tracePath.empty()) {
+        if (!SimTrace::loadFromTraceFile(options.tracePath, trace)) {
+            std::cout << "Error: Could not read trace '" << options.tracePath << "'." << std::endl;
+            return 1;
+        }
+    } else {
+        buildSyntheticTrace(options, trace);
+        // Same priorities test_cache configures for its generated files
+        for (const auto& type : defaultTestFileTypes()) {
+            priorities[type.extension] = type.importance;
+        }
+    }
+    for (const auto& priority : options.priorities) {
+        std::string ext = priority.first;
+        if (!ext.empty() && ext[0] != '.') {
+            ext = "." + ext;
+        }
+        priorities[ext] = priority.second;
+    }
+
+    uint64_t totalBytes = trace.getTotalObjectBytes();
+    uint64_t maxSize = options.maxSize ? options.maxSize : totalBytes;
+    uint64_t minSize = options.minSize ? options.minSize : std::max<uint64_t>(1, totalBytes / 100);
+    minSize = std::min(minSize, maxSize);
+
+    // Log-spaced capacities between minSize and maxSize
+    std::vector<uint64_t> capacities;
+    for (size_t i = 0; i < options.sizeCount; i++) {
+        double fraction = options.sizeCount > 1 ? static_cast<double>(i) / (options.sizeCount - 1) : 1.0;
+        double size = std::exp(std::log(static_cast<double>(minSize)) +
+                               fraction * (std::log(static_cast<double>(maxSize)) - std::log(static_cast<double>(minSize))));
+        capacities.push_back(static_cast<uint64_t>(size));
+    }
+
+    std::vector<float> typePriorities = resolveTypePriorities(trace, priorities);
+
+    std::cerr << "Simulating " << trace.accesses.size() << " accesses over " << trace.paths.size()
+              << " objects (" << totalBytes << " bytes): " << options.policies.size() << " policies x "
+              << capacities.size() << " sizes on " << options.jobs << " thread(s)" << std::endl;
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    std::vector<SimResult> results = runSimulationSweep(trace, options.policies, capacities,
+                                                        typePriorities, options.jobs);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+
+    if (options.csv) {
+        std::cout << "policy,capacity,hits,misses,hit_rate,byte_hit_rate" << std::endl;
+        for (const auto& result : results) {
+            std::cout << result.policy << "," << result.capacity << "," << result.hits << ","
+                      << result.misses << "," << result.hitRate() << "," << result.byteHitRate() << std::endl;
+        }
+    } else {
+        // One row per capacity, one hit-rate column per policy
+        std::cout << std::setw(14) << "capacity";
+        for (const auto& policy : options.policies) {
+            std::cout << std::setw(10) << policy;
+        }
+        std::cout << std::endl;
+
+        std::cout << std::fixed << std::setprecision(2);
+        for (size_t c = 0; c < capacities.size(); c++) {
+            std::cout << std::setw(14) << capacities[c];
+            for (size_t p = 0; p < options.policies.size(); p++) {
+                std::cout << std::setw(9) << results[p * capacities.size() + c].hitRate() * 100.0 << "%";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    std::cerr << "Sweep completed in " << duration.count() << "ms" << std::endl;
+    return 0;
+}
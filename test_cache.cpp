@@ -1,5 +1,8 @@
 // test_cache.cpp
 #include "content_aware_cache.h"
+#include "lru_cache.h"
+#include "workload_generator.h"
+#include "cache_simulator.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -31,12 +34,7 @@ void cleanTestDirectory(const std::string& dirPath) {
 // Enhanced Test Data Generator
 class TestDataGenerator {
 public:
-    struct FileTypeInfo {
-        std::string extension;
-        size_t minSize;
-        size_t maxSize;
-        float importance;
-    };
+    using FileTypeInfo = TestFileTypeInfo;
 
 private:
     std::mt19937 rng;
@@ -47,24 +45,15 @@ private:
     std::vector<FileTypeInfo> fileTypes;
     
 public:
-    TestDataGenerator(const std::string& dir)
-        : rng(std::random_device{}()), 
+    TestDataGenerator(const std::string& dir, unsigned seed = std::random_device{}())
+        : rng(seed), 
           charDist(65, 90),  // A-Z
           testDir(dir) {
         
         createTestDirectory(testDir);
         
         // Define various file types with different size ranges and importance
-        fileTypes = {
-            {".cfg", 1 * 1024, 10 * 1024, 0.9f},      // Small config files (high importance)
-            {".xml", 5 * 1024, 50 * 1024, 0.8f},      // Medium XML files (high importance)
-            {".json", 2 * 1024, 30 * 1024, 0.8f},     // Small-medium JSON files (high importance)
-            {".log", 100 * 1024, 500 * 1024, 0.6f},   // Larger log files (medium importance)
-            {".txt", 1 * 1024, 100 * 1024, 0.7f},     // Text files of various sizes (medium importance)
-            {".dat", 200 * 1024, 1024 * 1024, 0.4f},  // Large data files (lower importance)
-            {".bin", 500 * 1024, 2 * 1024 * 1024, 0.3f}, // Large binary files (lower importance)
-            {".tmp", 10 * 1024, 100 * 1024, 0.2f}     // Temporary files (lowest importance)
-        };
+        fileTypes = defaultTestFileTypes();
     }
     
     ~TestDataGenerator() {
@@ -103,261 +92,6 @@ public:
     }
 };
 
-// Enhanced LRU Cache implementation for comparison
-class LRUCache {
-private:
-    struct CacheItem {
-        std::string filePath;
-        std::vector<char> data;
-    };
-    
-    size_t maxCacheSize;
-    size_t currentCacheSize;
-    std::list<std::string> lruList;
-    std::unordered_map<std::string, std::pair<CacheItem, std::list<std::string>::iterator>> cache;
-    
-    size_t cacheHits;
-    size_t cacheMisses;
-    size_t diskReads;
-    
-public:
-    LRUCache(size_t maxSize) 
-        : maxCacheSize(maxSize), currentCacheSize(0), 
-          cacheHits(0), cacheMisses(0), diskReads(0) {}
-    
-    bool accessFile(const std::string& filePath) {
-        auto it = cache.find(filePath);
-        
-        if (it != cache.end()) {
-            // Cache hit
-            cacheHits++;
-            
-            // Move to front of LRU list
-            lruList.erase(it->second.second);
-            lruList.push_front(filePath);
-            it->second.second = lruList.begin();
-            
-            return true;
-        }
-        
-        // Cache miss
-        cacheMisses++;
-        
-        // Read file
-        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
-        if (!file) {
-            return false;
-        }
-        
-        size_t fileSize = file.tellg();
-        file.seekg(0, std::ios::beg);
-        
-        // Make room in cache if needed
-        while (currentCacheSize + fileSize > maxCacheSize && !lruList.empty()) {
-            std::string victimPath = lruList.back();
-            currentCacheSize -= cache[victimPath].first.data.size();
-            cache.erase(victimPath);
-            lruList.pop_back();
-        }
-        
-        // Add to cache if it fits
-        if (fileSize <= maxCacheSize) {
-            CacheItem item;
-            item.filePath = filePath;
-            item.data.resize(fileSize);
-            
-            file.read(item.data.data(), fileSize);
-            diskReads++;
-            
-            lruList.push_front(filePath);
-            cache[filePath] = {item, lruList.begin()};
-            currentCacheSize += fileSize;
-        } else {
-            // File too large for cache, just read it
-            diskReads++;
-        }
-        
-        return true;
-    }
-    
-    float getHitRate() const {
-        size_t totalAccesses = cacheHits + cacheMisses;
-        if (totalAccesses == 0) {
-            return 0.0f;
-        }
-        return static_cast<float>(cacheHits) / static_cast<float>(totalAccesses);
-    }
-    
-    size_t getDiskReadCount() const { return diskReads; }
-    size_t getCacheHits() const { return cacheHits; }
-    size_t getCacheMisses() const { return cacheMisses; }
-    size_t getCacheSize() const { return currentCacheSize; }
-    size_t getCacheEntryCount() const { return cache.size(); }
-};
-
-// Enhanced workload generator with realistic patterns
-class WorkloadGenerator {
-private:
-    std::mt19937 rng;
-    const std::vector<std::string>& files;
-    std::vector<std::string> fileTypes; // Store file extensions
-    
-public:
-    WorkloadGenerator(const std::vector<std::string>& fileSet) 
-        : rng(std::random_device{}()), files(fileSet) {
-        
-        // Extract file types from paths
-        for (const auto& file : files) {
-            fs::path path(file);
-            fileTypes.push_back(path.extension().string());
-        }
-    }
-    
-    // Generate workload with three phases to simulate real application behavior
-    std::vector<std::string> generateRealisticWorkload(size_t totalAccesses) {
-        std::vector<std::string> workload;
-        
-        // Phase 1 (30%): Application startup - config files loaded, initial resources accessed
-        size_t startupPhase = totalAccesses * 0.3;
-        workload.reserve(totalAccesses);
-        
-        // Config files accessed first
-        for (size_t i = 0; i < files.size(); i++) {
-            if (fileTypes[i] == ".cfg" || fileTypes[i] == ".json" || fileTypes[i] == ".xml") {
-                // Access config files multiple times during startup
-                for (int j = 0; j < 5 && workload.size() < startupPhase; j++) {
-                    workload.push_back(files[i]);
-                }
-            }
-        }
-        
-        // Fill remaining startup phase with random accesses
-        std::uniform_int_distribution<size_t> fileDist(0, files.size() - 1);
-        while (workload.size() < startupPhase) {
-            workload.push_back(files[fileDist(rng)]);
-        }
-        
-        // Phase 2 (60%): Normal operation - locality with occasional bursts
-        size_t operationPhase = totalAccesses * 0.6;
-        size_t normalOpEnd = startupPhase + operationPhase;
-        
-        // Set up clusters of related file accesses
-        size_t clusterSize = 5;
-        while (workload.size() < normalOpEnd) {
-            // Choose a random starting file
-            size_t baseFile = fileDist(rng);
-            
-            // Create a cluster of accesses around this file and similar types
-            for (size_t i = 0; i < clusterSize && workload.size() < normalOpEnd; i++) {
-                // Sometimes access the base file
-                if (i % 2 == 0) {
-                    workload.push_back(files[baseFile]);
-                } else {
-                    // Find a file with the same extension
-                    std::string targetExt = fileTypes[baseFile];
-                    std::vector<size_t> sameTypeFiles;
-                    
-                    for (size_t j = 0; j < files.size(); j++) {
-                        if (fileTypes[j] == targetExt) {
-                            sameTypeFiles.push_back(j);
-                        }
-                    }
-                    
-                    if (!sameTypeFiles.empty()) {
-                        std::uniform_int_distribution<size_t> sameDist(0, sameTypeFiles.size() - 1);
-                        workload.push_back(files[sameTypeFiles[sameDist(rng)]]);
-                    } else {
-                        workload.push_back(files[fileDist(rng)]);
-                    }
-                }
-            }
-            
-            // Occasionally access some random files (context switch)
-            if (std::uniform_real_distribution<float>(0, 1)(rng) < 0.3) {
-                for (size_t i = 0; i < 3 && workload.size() < normalOpEnd; i++) {
-                    workload.push_back(files[fileDist(rng)]);
-                }
-            }
-        }
-        
-        // Phase 3 (10%): Application wind-down - log files, cleanup
-        while (workload.size() < totalAccesses) {
-            // Higher probability of accessing log files
-            bool accessLog = std::uniform_real_distribution<float>(0, 1)(rng) < 0.6;
-            
-            if (accessLog) {
-                // Find and access a log file
-                std::vector<size_t> logFiles;
-                for (size_t i = 0; i < files.size(); i++) {
-                    if (fileTypes[i] == ".log") {
-                        logFiles.push_back(i);
-                    }
-                }
-                
-                if (!logFiles.empty()) {
-                    std::uniform_int_distribution<size_t> logDist(0, logFiles.size() - 1);
-                    workload.push_back(files[logFiles[logDist(rng)]]);
-                } else {
-                    workload.push_back(files[fileDist(rng)]);
-                }
-            } else {
-                // Random access to any file
-                workload.push_back(files[fileDist(rng)]);
-            }
-        }
-        
-        return workload;
-    }
-    
-    // Specific pattern that heavily favors important files
-    std::vector<std::string> generateImportantFilesBurstWorkload(size_t totalAccesses) {
-        std::vector<std::string> workload;
-        workload.reserve(totalAccesses);
-        
-        std::uniform_int_distribution<size_t> fileDist(0, files.size() - 1);
-        
-        // Group files by extension
-        std::unordered_map<std::string, std::vector<size_t>> filesByType;
-        for (size_t i = 0; i < files.size(); i++) {
-            filesByType[fileTypes[i]].push_back(i);
-        }
-        
-        // List of important extensions in order of importance
-        std::vector<std::string> importantExts = {".cfg", ".json", ".xml", ".txt"};
-        
-        size_t pos = 0;
-        while (pos < totalAccesses) {
-            // Random extension burst (70% of accesses)
-            std::string burstExt = importantExts[std::uniform_int_distribution<size_t>(0, importantExts.size() - 1)(rng)];
-            
-            // If we have files of this type
-            if (!filesByType[burstExt].empty()) {
-                // Determine burst length (5-20 accesses)
-                size_t burstLength = std::uniform_int_distribution<size_t>(5, 20)(rng);
-                burstLength = std::min(burstLength, totalAccesses - pos);
-                
-                for (size_t i = 0; i < burstLength; i++) {
-                    // Pick random file of this type
-                    size_t fileIndex = filesByType[burstExt][std::uniform_int_distribution<size_t>(0, filesByType[burstExt].size() - 1)(rng)];
-                    workload.push_back(files[fileIndex]);
-                    pos++;
-                }
-            }
-            
-            // Random accesses (30% of total)
-            size_t randomLength = std::uniform_int_distribution<size_t>(1, 5)(rng);
-            randomLength = std::min(randomLength, totalAccesses - pos);
-            
-            for (size_t i = 0; i < randomLength; i++) {
-                workload.push_back(files[fileDist(rng)]);
-                pos++;
-            }
-        }
-        
-        return workload;
-    }
-};
-
 // Test function for standard caching
 void testStandardCaching(const std::vector<std::string>& workload, size_t cacheSize) {
     std::cout << "Testing standard LRU caching..." << std::endl;
@@ -390,6 +124,9 @@ void testContentAwareCaching(const std::vector<std::string>& workload, size_t ca
     
     auto cache = std::make_shared<ContentAwareCache>(cacheSize);
     
+    // Track reuse distances of every path (the data set is too small to sample)
+    cache->enableMissRatioCurve(1.0);
+    
     // Set file type priorities based on the file type information
     for (const auto& type : fileTypes) {
         cache->setFileTypePriority(type.extension, type.importance);
@@ -413,6 +150,74 @@ void testContentAwareCaching(const std::vector<std::string>& workload, size_t ca
     std::cout << "Content-Aware Results:" << std::endl;
     cache->printStats();
     std::cout << "  Execution Time: " << duration.count() << "ms" << std::endl;
+    std::cout << "  Predicted LRU Hit Rate (SHARDS): " << (cache->getPredictedHitRate(cacheSize) * 100.0f) << "%" << std::endl;
+}
+
+// Test function for the metadata-only simulator on the same workload
+void testSimulatedCaching(const std::vector<std::string>& workload, size_t cacheSize,
+                          const std::vector<TestDataGenerator::FileTypeInfo>& fileTypes) {
+    std::cout << "Testing metadata-only simulation..." << std::endl;
+    
+    SimTrace trace;
+    for (const auto& filePath : workload) {
+        trace.accesses.push_back(trace.addObject(filePath, fs::file_size(filePath)));
+    }
+    
+    auto priorities = ContentAwareCache::defaultFileTypePriorities();
+    for (const auto& type : fileTypes) {
+        priorities[type.extension] = type.importance;
+    }
+    std::vector<float> typePriorities = resolveTypePriorities(trace, priorities);
+    
+    auto startTime = std::chrono::high_resolution_clock::now();
+    std::vector<SimResult> results = runSimulationSweep(trace, simPolicyNames(), {cacheSize}, typePriorities, 1);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+    
+    std::cout << "Simulation Results:" << std::endl;
+    for (const auto& result : results) {
+        std::cout << "  " << result.policy << " Hit Rate: " << (result.hitRate() * 100.0) << "%"
+                  << " (byte hit rate " << (result.byteHitRate() * 100.0) << "%)" << std::endl;
+    }
+    std::cout << "  Execution Time: " << duration.count() << "ms" << std::endl;
+}
+
+// Validate policies on the seeded scan-resistance workloads (simulated, no disk I/O)
+void testWorkloadSuite(const std::vector<std::string>& testFiles, size_t cacheSize,
+                       const std::vector<TestDataGenerator::FileTypeInfo>& fileTypes, unsigned seed) {
+    std::cout << "Testing policies on seeded workloads..." << std::endl;
+    
+    SimTrace trace;
+    for (const auto& filePath : testFiles) {
+        trace.addObject(filePath, fs::file_size(filePath));
+    }
+    
+    auto priorities = ContentAwareCache::defaultFileTypePriorities();
+    for (const auto& type : fileTypes) {
+        priorities[type.extension] = type.importance;
+    }
+    std::vector<float> typePriorities = resolveTypePriorities(trace, priorities);
+    
+    WorkloadGenerator workloadGen(testFiles, seed);
+    size_t hotSetSize = testFiles.size() / 10;
+    std::vector<std::pair<std::string, std::vector<size_t>>> workloads = {
+        {"zipf(0.9)", workloadGen.generateZipfWorkload(20000, 0.9)},
+        {"hot-set shift", workloadGen.generateHotSetShiftWorkload(20000, hotSetSize, 2000)},
+        {"scan + hot set", workloadGen.generateScanWithHotSetWorkload(20000, hotSetSize, 500)},
+        {"loop > cache", workloadGen.generateLoopWorkload(20000, testFiles.size())}
+    };
+    
+    std::vector<std::string> policies = {"lru", "content"};
+    for (auto& workload : workloads) {
+        trace.accesses.assign(workload.second.begin(), workload.second.end());
+        std::vector<SimResult> results = runSimulationSweep(trace, policies, {cacheSize}, typePriorities, 1);
+        
+        std::cout << "  " << workload.first << ":";
+        for (const auto& result : results) {
+            std::cout << " " << result.policy << " " << (result.hitRate() * 100.0) << "%";
+        }
+        std::cout << std::endl;
+    }
 }
 
 // Main program
@@ -421,13 +226,16 @@ int main() {
     std::cout << "=====================================" << std::endl;
     
     // Create test files with diverse types and sizes
-    TestDataGenerator generator("./test_files");
+    // Fixed seed so data sets and workloads are identical from run to run
+    const unsigned seed = 42;
+    
+    TestDataGenerator generator("./test_files", seed);
     std::vector<std::string> testFiles = generator.generateTestSet(100); // Increase to 100 files
     
     std::cout << "Created " << testFiles.size() << " test files." << std::endl;
     
     // Create workload generator
-    WorkloadGenerator workloadGen(testFiles);
+    WorkloadGenerator workloadGen(testFiles, seed);
     
     // Generate a realistic workload
     std::vector<std::string> realisticWorkload = workloadGen.generateRealisticWorkload(20000);
@@ -457,6 +265,11 @@ int main() {
     // Test content-aware caching
     testContentAwareCaching(realisticWorkload, cacheSize, generator.getFileTypes());
     
+    std::cout << std::endl;
+    
+    // Simulate every policy on the same workload without touching the disk
+    testSimulatedCaching(realisticWorkload, cacheSize, generator.getFileTypes());
+    
     std::cout << "\n--- Additional Test: Important Files Burst Pattern ---\n" << std::endl;
     
     // Generate workload with bursts of important file accesses
@@ -472,5 +285,9 @@ int main() {
     // Test content-aware caching
     testContentAwareCaching(burstWorkload, cacheSize, generator.getFileTypes());
     
+    std::cout << "\n--- Additional Test: Seeded Scan-Resistance Workloads ---\n" << std::endl;
+    
+    testWorkloadSuite(testFiles, cacheSize, generator.getFileTypes(), seed);
+    
     return 0;
 }
\ No newline at end of file
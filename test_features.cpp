@@ -0,0 +1,804 @@
+// test_features.cpp
+// Behaviour checks for the cache's concurrency, memory and I/O features.
+// Exits with a non-zero status if any check fails (make check).
+#include "content_aware_cache.h"
+#include "numa_topology.h"
+#include "flat_path_index.h"
+#include "payload_arena.h"
+#include "file_type_table.h"
+#include "io_scheduler.h"
+#include "access_trace.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const std::string TEST_DIR = "./test_features_files";
+
+int failedChecks = 0;
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            std::cout << "    FAILED: " #condition " (line " << __LINE__ << ")" << std::endl; \
+            failedChecks++;                                                               \
+        }                                                                                 \
+    } while (0)
+
+std::string writeTestFile(const std::string& name, const std::string& contents) {
+    std::string path = TEST_DIR + "/" + name;
+    std::ofstream file(path, std::ios::binary);
+    file.write(contents.data(), contents.size());
+    return path;
+}
+
+// Reads a whole handle from its current position
+std::string readAll(CacheFile& file) {
+    std::string contents;
+    char buffer[4096];
+    size_t count;
+    while ((count = file.read(buffer, 1, sizeof(buffer))) > 0) {
+        contents.append(buffer, count);
+    }
+    return contents;
+}
+
+// Reads a file straight from the disk
+std::string readDisk(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// NUMA node lists with gaps keep only the online nodes
+void testNumaNodeList() {
+    std::vector<int> nodes = NumaTopology::parseNodeList("0,2\n");
+    CHECK((nodes == std::vector<int>{0, 2}));
+    CHECK((NumaTopology::parseNodeList("0-1,3") == std::vector<int>{0, 1, 3}));
+    CHECK(NumaTopology::parseNodeList("x").empty());
+
+    NumaTopology sparse(nodes);
+    CHECK(sparse.getNodeCount() == 3);
+    CHECK(sparse.isMultiNode());
+    CHECK(sparse.isOnline(0));
+    CHECK(!sparse.isOnline(1));
+    CHECK(sparse.isOnline(2));
+    CHECK(sparse.getOnlineNodes() == nodes);
+
+    NumaTopology single((std::vector<int>()));
+    CHECK(!single.isMultiNode());
+    CHECK(single.getOnlineNodes() == std::vector<int>{0});
+}
+
+// Shutdown runs queued demand and write-back work, drops prefetches and refuses new tasks
+void testExecutorShutdownWithQueuedWork() {
+    ExecutorOptions options;
+    options.threads = 1;
+    CacheExecutor pool(options);
+
+    std::atomic<bool> go(false);
+    std::atomic<int> writeBacks(0);
+    std::atomic<int> prefetches(0);
+    CHECK(pool.submit(TaskLane::Demand, [&] {
+        while (!go.load()) {
+            std::this_thread::yield();
+        }
+    }));
+    for (int i = 0; i < 5; i++) {
+        CHECK(pool.submit(TaskLane::WriteBack, [&] { writeBacks++; }));
+        CHECK(pool.submit(TaskLane::Prefetch, [&] { prefetches++; }));
+    }
+
+    std::thread release([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        go = true;
+    });
+    pool.shutdown();
+    release.join();
+
+    CHECK(writeBacks == 5);
+    CHECK(prefetches == 0);
+    CHECK(pool.getCompletedTasks(TaskLane::WriteBack) == 5);
+    CHECK(pool.getQueuedTasks(TaskLane::Prefetch) == 0);
+    CHECK(!pool.submit(TaskLane::Demand, [] {}));
+}
+
+// A task that drops the last owner of its pool shuts the pool down from a worker
+void testExecutorReleasedByItsOwnTask() {
+    struct PoolOwner {
+        std::unique_ptr<CacheExecutor> pool;
+        std::promise<void> destroyed;
+        ~PoolOwner() {
+            pool->shutdown();
+            pool.reset();
+            destroyed.set_value();
+        }
+    };
+
+    auto owner = std::make_shared<PoolOwner>();
+    ExecutorOptions options;
+    options.threads = 2;
+    owner->pool.reset(new CacheExecutor(options));
+    std::future<void> destroyed = owner->destroyed.get_future();
+
+    CacheExecutor* pool = owner->pool.get();
+    CHECK(pool->submit(TaskLane::Demand, [owner = std::move(owner)]() mutable { owner.reset(); }));
+    CHECK(destroyed.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+}
+
+// A thread alternating between two recorders keeps one thread id in each trace
+void testTraceThreadIdsPerRecorder() {
+    std::string firstPath = TEST_DIR + "/first.trace";
+    std::string secondPath = TEST_DIR + "/second.trace";
+    {
+        TraceRecorder first(firstPath);
+        TraceRecorder second(secondPath);
+        std::thread([&] { first.record(TraceOp::Open, first.internPath("other"), 0, 0); }).join();
+        for (int i = 0; i < 3; i++) {
+            first.record(TraceOp::Read, first.internPath("a"), 0, 1);
+            second.record(TraceOp::Read, second.internPath("b"), 0, 1);
+        }
+    }
+
+    TraceReader reader;
+    CHECK(reader.open(firstPath));
+    std::vector<TraceRecord> records = reader.readAll();
+    CHECK(records.size() == 4);
+    for (size_t i = 1; i < records.size(); i++) {
+        CHECK(records[i].threadId == 1);
+    }
+
+    TraceReader secondReader;
+    CHECK(secondReader.open(secondPath));
+    for (const TraceRecord& record : secondReader.readAll()) {
+        CHECK(record.threadId == 0);
+    }
+}
+
+// Index value for the FlatPathIndex checks
+struct IndexedPath {
+    std::string key;
+    int id = -1;
+    const std::string& path() const { return key; }
+};
+
+// Erased slots in full groups stay probeable, are reused, and rehashing drops them
+void testPathIndexTombstonesAndResize() {
+    FlatPathIndex<IndexedPath> index;
+    std::vector<std::string> paths;
+    for (int i = 0; i < 1000; i++) {
+        paths.push_back("/data/file" + std::to_string(i) + ".txt");
+        index.insert(hashPath(paths[i]), IndexedPath{paths[i], i});
+    }
+    CHECK(index.size() == 1000);
+    CHECK(index.getCapacity() >= 1000 * 8 / 7);
+    CHECK((index.getCapacity() & (index.getCapacity() - 1)) == 0);
+    bool allFound = true;
+    for (int i = 0; i < 1000; i++) {
+        auto* slot = index.find(paths[i]);
+        allFound = allFound && slot && slot->value.id == i;
+    }
+    CHECK(allFound);
+    CHECK(!index.find("/data/missing.txt"));
+
+    // Forty paths with one home group and only four tags overflow into later
+    // groups, so erasing from the full home group leaves tombstones behind
+    FlatPathIndex<IndexedPath> colliding;
+    auto hashOf = [](int i) { return static_cast<uint64_t>(i % 4); };
+    for (int i = 0; i < 40; i++) {
+        colliding.insert(hashOf(i), IndexedPath{"collide" + std::to_string(i), i});
+    }
+    size_t capacity = colliding.getCapacity();
+    for (int i = 0; i < 40; i += 2) {
+        colliding.erase(colliding.find("collide" + std::to_string(i), hashOf(i)));
+    }
+    CHECK(colliding.size() == 20);
+    bool survivorsFound = true;
+    for (int i = 1; i < 40; i += 2) {
+        auto* slot = colliding.find("collide" + std::to_string(i), hashOf(i));
+        survivorsFound = survivorsFound && slot && slot->value.id == i;
+    }
+    CHECK(survivorsFound);
+    CHECK(!colliding.find("collide0", hashOf(0)));
+
+    // Churn at a constant size reuses or sweeps tombstones instead of growing
+    for (int round = 0; round < 200; round++) {
+        int i = 40 + round;
+        colliding.insert(hashOf(i), IndexedPath{"collide" + std::to_string(i), i});
+        colliding.erase(colliding.find("collide" + std::to_string(i), hashOf(i)));
+    }
+    CHECK(colliding.size() == 20);
+    CHECK(colliding.getCapacity() == capacity);
+    survivorsFound = true;
+    for (int i = 1; i < 40; i += 2) {
+        auto* slot = colliding.find("collide" + std::to_string(i), hashOf(i));
+        survivorsFound = survivorsFound && slot && slot->value.id == i;
+    }
+    CHECK(survivorsFound);
+
+    size_t visited = 0;
+    colliding.forEach([&](const IndexedPath& value) { visited += value.id % 2; });
+    CHECK(visited == 20);
+}
+
+// Compaction moves blocks out of sparse pages with their contents intact,
+// leaves blocks of entries with open handles in place, and releases emptied pages
+void testArenaCompaction() {
+    std::unique_ptr<PayloadArena, PayloadArena::Releaser> arena(new PayloadArena());
+    const size_t blockSize = 3000;  // about 85 blocks per page
+    std::vector<std::shared_ptr<CacheEntry>> entries;
+    for (size_t i = 0; i < 400; i++) {
+        auto entry = CacheEntry::create("arena" + std::to_string(i), 0, blockSize);
+        entry->data.resizeUninitialized(blockSize, arena.get(), entry.get());
+        std::memset(entry->data.data(), static_cast<int>(i % 251), blockSize);
+        entries.push_back(std::move(entry));
+    }
+    size_t pagesBefore = arena->getPageCount();
+    CHECK(pagesBefore >= 4);
+
+    // Keep one block in four, so every filled page drops below half live
+    std::vector<std::pair<size_t, std::shared_ptr<CacheEntry>>> kept;
+    for (size_t i = 0; i < entries.size(); i += 4) {
+        kept.emplace_back(i, entries[i]);
+    }
+    entries.clear();
+    size_t liveBefore = arena->getLiveBytes();
+
+    CacheEntry& pinned = *kept.front().second;
+    const char* pinnedBytes = pinned.data.data();
+    pinned.openHandles = 1;
+    CHECK(arena->compact() > 0);
+    CHECK(arena->getPageCount() < pagesBefore);
+    CHECK(arena->getLiveBytes() == liveBefore);
+    CHECK(pinned.data.data() == pinnedBytes);
+    pinned.openHandles = 0;
+
+    for (const auto& pair : kept) {
+        const CachePayload& data = pair.second->data;
+        bool intact = data.size() == blockSize;
+        for (size_t j = 0; intact && j < blockSize; j++) {
+            intact = static_cast<unsigned char>(data.data()[j]) == pair.first % 251;
+        }
+        CHECK(intact);
+    }
+}
+
+// Built-in types resolve to their fixed ids, and types past the id space
+// share the overflow id instead of the empty extension's
+void testFileTypeTable() {
+    static_assert(FileTypeTable::findBuiltin(".json") != 0, "built-ins resolve at compile time");
+    for (size_t i = 0; i < BUILTIN_FILE_TYPE_COUNT; i++) {
+        CHECK(FileTypeTable::findBuiltin(BUILTIN_FILE_TYPES[i].extension) == i + 1);
+    }
+    CHECK(FileTypeTable::findBuiltin(".jso") == 0);
+    CHECK(FileTypeTable::findBuiltin("") == 0);
+    CHECK(FileTypeTable::extensionOf("dir.d/archive.tar.gz") == ".gz");
+    CHECK(FileTypeTable::extensionOf("dir.d/.hidden") == "");
+
+    FileTypeTable table(0.25f);
+    CHECK(table.intern("") == 0);
+    CHECK(table.intern(".cfg") == FileTypeTable::findBuiltin(".cfg"));
+    CHECK(table.getPriority(table.intern(".cfg")) == 0.9f);
+    FileTypeId first = table.intern(".custom");
+    CHECK(first == BUILTIN_FILE_TYPE_COUNT + 1);
+    CHECK(table.intern(".custom") == first);
+
+    size_t added = 0;
+    while (table.size() < FileTypeTable::OVERFLOW_TYPE) {
+        CHECK(table.intern(".t" + std::to_string(added++)) == table.size() - 1);
+    }
+    FileTypeId overflow = table.intern(".past-the-limit");
+    CHECK(overflow == FileTypeTable::OVERFLOW_TYPE);
+    CHECK(table.intern(".also-past") == FileTypeTable::OVERFLOW_TYPE);
+    CHECK(table.intern(".t0") == first + 1);
+    CHECK(table.intern("") == 0);
+
+    table.setPriority(overflow, 1.0f);
+    CHECK(table.getPriority(overflow) == 0.25f);
+    CHECK(table.getPriority(0) == 0.25f);
+}
+
+// Demand I/O is admitted past queued background work, write-back goes before
+// prefetch, and a class's IOPS limit paces its requests
+void testIoSchedulerPriorityAndLimits() {
+    IoScheduler scheduler(2);
+    std::mutex orderMutex;
+    std::vector<IoClass> order;
+    auto admit = [&](IoClass ioClass) {
+        IoScheduler::Ticket ticket = scheduler.acquire(ioClass, 4096);
+        {
+            std::lock_guard<std::mutex> lock(orderMutex);
+            order.push_back(ioClass);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    };
+
+    // One slot in use leaves none for background classes
+    IoScheduler::Ticket held = scheduler.acquire(IoClass::Demand, 4096);
+    std::thread prefetch(admit, IoClass::Prefetch);
+    std::thread writeBack(admit, IoClass::WriteBack);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::thread demand(admit, IoClass::Demand);
+    demand.join();
+    held.release();
+    writeBack.join();
+    prefetch.join();
+    CHECK((order == std::vector<IoClass>{IoClass::Demand, IoClass::WriteBack, IoClass::Prefetch}));
+    CHECK(scheduler.getOps(IoClass::Demand) == 2);
+    CHECK(scheduler.getBytes(IoClass::WriteBack) == 4096);
+
+    // 20 IOPS with a 0.1s burst: two requests at once, then one every 50ms
+    IoClassLimits limits;
+    limits.opsPerSecond = 20;
+    scheduler.setLimits(IoClass::Prefetch, limits);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 6; i++) {
+        scheduler.acquire(IoClass::Prefetch, 1);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    CHECK(elapsed >= std::chrono::milliseconds(150));
+    CHECK(elapsed < std::chrono::seconds(2));
+    CHECK(scheduler.getOps(IoClass::Prefetch) == 7);
+}
+
+// A miss held back by the demand rate limit does not hold up hits on other files
+void testThrottledMissDoesNotBlockHits() {
+    std::string hot = writeTestFile("hot.txt", "hot contents");
+    std::string first = writeTestFile("throttle_first.dat", std::string(200 * 1024, 'a'));
+    std::string second = writeTestFile("throttle_second.dat", std::string(1024, 'b'));
+    auto cache = std::make_shared<ContentAwareCache>(16 * 1024 * 1024);
+    CHECK(cache->open(hot, "r").isOpen());
+
+    // The first miss empties the bucket and leaves about two seconds of debt
+    IoClassLimits limits;
+    limits.bytesPerSecond = 100 * 1024;
+    cache->setIoLimits(IoClass::Demand, limits);
+    CHECK(cache->open(first, "r").isOpen());
+
+    std::atomic<bool> missDone(false);
+    std::thread miss([&] {
+        CacheFile file = cache->open(second, "r");
+        missDone = file.isOpen();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        CacheFile file = cache->open(hot, "r");
+        CHECK(file.wasCacheHit());
+        CHECK(readAll(file) == "hot contents");
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    CHECK(!missDone);
+    CHECK(elapsed < std::chrono::milliseconds(500));
+
+    miss.join();
+    CHECK(missDone);
+    cache->setIoLimits(IoClass::Demand, IoClassLimits());
+}
+
+// Concurrent misses on one path read the file once
+void testConcurrentMissesReadOnce() {
+    std::string path = writeTestFile("shared_miss.dat", std::string(64 * 1024, 'c'));
+    auto cache = std::make_shared<ContentAwareCache>(16 * 1024 * 1024);
+
+    // Slow enough that every thread arrives while the first read waits
+    IoClassLimits limits;
+    limits.opsPerSecond = 5;
+    cache->setIoLimits(IoClass::Demand, limits);
+    CHECK(cache->open(writeTestFile("warmup.dat", "x"), "r").isOpen());
+
+    std::vector<std::thread> threads;
+    std::atomic<int> opened(0);
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&] {
+            CacheFile file = cache->open(path, "r");
+            if (file && readAll(file) == std::string(64 * 1024, 'c')) {
+                opened++;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(opened == 4);
+    CHECK(cache->getDiskReadCount() == 2);
+    CHECK(cache->getIoScheduler().getOps(IoClass::Demand) == 2);
+    cache->setIoLimits(IoClass::Demand, IoClassLimits());
+}
+
+// fopen mode strings, including glibc's suffixes, parse to the expected flags
+void testOpenModeTable() {
+    const struct {
+        const char* mode;
+        uint8_t flags;
+    } modes[] = {
+        {"r", MODE_READ},
+        {"rb", MODE_READ | MODE_BINARY},
+        {"r+", MODE_READ | MODE_WRITE},
+        {"re", MODE_READ},
+        {"rm", MODE_READ},
+        {"rbe", MODE_READ | MODE_BINARY},
+        {"w", MODE_WRITE | MODE_TRUNCATE | MODE_CREATE},
+        {"wx", MODE_WRITE | MODE_TRUNCATE | MODE_CREATE | MODE_EXCLUSIVE},
+        {"w+e", MODE_READ | MODE_WRITE | MODE_TRUNCATE | MODE_CREATE},
+        {"a", MODE_WRITE | MODE_APPEND | MODE_CREATE},
+        {"ax", MODE_WRITE | MODE_APPEND | MODE_CREATE | MODE_EXCLUSIVE},
+        {"a+", MODE_READ | MODE_WRITE | MODE_APPEND | MODE_CREATE},
+        {"rx", MODE_INVALID},
+        {"r?", MODE_INVALID},
+        {"", MODE_INVALID},
+    };
+    for (const auto& entry : modes) {
+        if (parseOpenMode(entry.mode) != entry.flags) {
+            std::cout << "    mode \"" << entry.mode << "\"" << std::endl;
+            CHECK(parseOpenMode(entry.mode) == entry.flags);
+        }
+    }
+    static_assert(parseOpenMode("re") == MODE_READ, "parseOpenMode stays constexpr");
+}
+
+// Every mode opens an existing empty file, as fopen does, and writes reach the disk
+void testEmptyFileModes() {
+    const struct {
+        const char* mode;
+        const char* written;   // appended through the handle, if it can write
+        const char* expected;  // on disk after close
+    } modes[] = {
+        {"r", "", ""},
+        {"r+", "update", "update"},
+        {"a", "append", "append"},
+        {"a+", "append", "append"},
+        {"w", "write", "write"},
+        {"ax", "", ""},
+    };
+    for (const auto& entry : modes) {
+        std::string path = writeTestFile("empty.txt", "");
+        auto cache = std::make_shared<ContentAwareCache>(16 * 1024 * 1024);
+        {
+            CacheFile file = cache->open(path, entry.mode);
+            bool exclusive = std::string(entry.mode) == "ax";
+            CHECK(file.isOpen() != exclusive);
+            if (!file.isOpen()) {
+                continue;
+            }
+            CHECK(file.seek(0, SEEK_END) == 0 && file.tell() == 0);
+            size_t length = std::string(entry.written).size();
+            if (length > 0) {
+                CHECK(file.write(entry.written, 1, length) == length);
+            }
+        }
+        CHECK(readDisk(path) == entry.expected);
+    }
+}
+
+// Readers keep the version they opened while a writer publishes; new opens see the new one
+void testSnapshotIsolation() {
+    std::string path = writeTestFile("isolation.txt", "original contents");
+    auto cache = std::make_shared<ContentAwareCache>(16 * 1024 * 1024);
+    CacheFile reader = cache->open(path, "r");
+    CacheFile writer = cache->open(path, "r+");
+
+    CHECK(writer.write("CHANGED!", 1, 8) == 8);
+    // The writer's private copy is held memory until it is published
+    CHECK(cache->getZombieBytes() >= 17);
+    CHECK(readAll(reader) == "original contents");
+    CHECK(readAll(writer) == " contents");
+    {
+        CacheFile before = cache->open(path, "r");
+        CHECK(readAll(before) == "original contents");
+    }
+
+    CHECK(writer.flush() == 0);
+    {
+        CacheFile after = cache->open(path, "r");
+        CHECK(readAll(after) == "CHANGED! contents");
+    }
+    CHECK(reader.seek(0, SEEK_SET) == 0);
+    CHECK(readAll(reader) == "original contents");
+    writer.close();
+    reader.close();
+
+    // An append-only handle publishes the base with its tail; earlier readers keep the base
+    CacheFile older = cache->open(path, "r");
+    CacheFile appender = cache->open(path, "a");
+    CHECK(appender.write(", appended", 1, 10) == 10);
+    CHECK(appender.tell() == 27);
+    CHECK(cache->getZombieBytes() == 0);
+    CHECK(appender.flush() == 0);
+    CHECK(readAll(older) == "CHANGED! contents");
+    {
+        CacheFile after = cache->open(path, "r");
+        CHECK(readAll(after) == "CHANGED! contents, appended");
+    }
+    older.close();
+    CHECK(appender.write("!", 1, 1) == 1);
+    appender.close();
+    {
+        CacheFile after = cache->open(path, "r");
+        CHECK(readAll(after) == "CHANGED! contents, appended!");
+    }
+
+    CHECK(readDisk(path) == "CHANGED! contents, appended!");
+}
+
+// Bytes held by handles after eviction, and a writer's copy, are given back as the handles close
+void testZombieBytesReleased() {
+    std::string path = writeTestFile("held.dat", std::string(5000, 'h'));
+    std::string other = writeTestFile("other.txt", "x");
+    auto cache = std::make_shared<ContentAwareCache>(16 * 1024 * 1024);
+    CacheFile reader = cache->open(path, "r");
+    CacheFile writer = cache->open(path, "r+");
+
+    CHECK(writer.write("H", 1, 1) == 1);
+    CHECK(cache->getZombieBytes() == 5000);
+    cache->clear();
+    CHECK(cache->getCacheEntryCount() == 0);
+    CHECK(cache->getZombieBytes() == 10000);
+
+    // Published into the evicted entry; the reader still holds the old version
+    writer.close();
+    CHECK(cache->getZombieBytes() == 10000);
+    CHECK(readAll(reader) == std::string(5000, 'h'));
+    reader.close();
+
+    // Closes are applied by the next operation that takes the lock
+    CHECK(cache->open(other, "r").isOpen());
+    CHECK(cache->getZombieBytes() == 0);
+    CHECK(cache->getCacheSize() == 1);
+}
+
+// Two handles appending to one file both keep their bytes, in publish order
+void testConcurrentAppenders() {
+    std::string path = writeTestFile("appenders.log", "base\n");
+    auto cache = std::make_shared<ContentAwareCache>(16 * 1024 * 1024);
+    CacheFile first = cache->open(path, "a");
+    CacheFile second = cache->open(path, "a");
+    CHECK(first.write("A\n", 1, 2) == 2);
+    CHECK(second.write("B\n", 1, 2) == 2);
+    first.close();
+    second.close();
+
+    {
+        CacheFile file = cache->open(path, "r");
+        CHECK(readAll(file) == "base\nA\nB\n");
+    }
+    CHECK(readDisk(path) == "base\nA\nB\n");
+    CHECK(cache->getZombieBytes() == 0);
+}
+
+// Runs body on a thread that first makes path hot enough to be replicated,
+// keeping the thread alive (and its replica unused) until body returns
+void withIdleReplica(ContentAwareCache& cache, const std::string& path, const std::function<void()>& body) {
+    std::promise<void> replicated;
+    std::promise<void> finished;
+    std::thread reader([&] {
+        for (int i = 0; i < 100; i++) {
+            CacheFile file = cache.open(path, "r");
+        }
+        replicated.set_value();
+        finished.get_future().wait();
+    });
+    replicated.get_future().wait();
+    body();
+    finished.set_value();
+    reader.join();
+}
+
+// Evicting or rewriting a replicated entry releases the replica's pin at once
+void testReplicaReleasedOnEviction() {
+    std::string path = writeTestFile("replicated.txt", std::string(1000, 'r'));
+    auto cache = std::make_shared<ContentAwareCache>(16 * 1024 * 1024);
+
+    withIdleReplica(*cache, path, [&] {
+        cache->clear();
+        CHECK(cache->getCacheEntryCount() == 0);
+        CHECK(cache->getZombieBytes() == 0);
+    });
+
+    withIdleReplica(*cache, path, [&] {
+        {
+            CacheFile writer = cache->open(path, "w");
+            CHECK(writer.write("rewritten", 1, 9) == 9);
+        }
+        CHECK(cache->getZombieBytes() == 0);
+        CHECK(cache->getCacheSize() == 9);
+    });
+
+    std::string seen;
+    std::thread reader([&] {
+        CacheFile file = cache->open(path, "r");
+        seen = readAll(file);
+    });
+    reader.join();
+    CHECK(seen == "rewritten");
+}
+
+// Write-back replaces files whole, skips clean entries, and a miss during it
+// waits for the new file rather than reading the old one
+void testWriteBackReplacesWholeFiles() {
+    const size_t size = 4 * 1024 * 1024;
+    std::string path = writeTestFile("writeback.dat", std::string(size, 'o'));
+    std::string clean = writeTestFile("clean.txt", "clean");
+    auto cache = std::make_shared<ContentAwareCache>(64 * 1024 * 1024);
+    CHECK(cache->open(clean, "r").isOpen());
+    std::string contents(size, 'n');
+    cache->insert(path, contents.data(), contents.size());
+
+    IoClassLimits limits;
+    limits.bytesPerSecond = 2 * 1024 * 1024;
+    cache->setIoLimits(IoClass::WriteBack, limits);
+    std::future<void> written = cache->flushAsync();
+    std::this_thread::sleep_for(std::chrono::milliseconds(700));
+
+    // Mid-write the disk still has the whole old file
+    CHECK(written.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+    CHECK(readDisk(path) == std::string(size, 'o'));
+
+    // Evicted while being written; the miss gets the new contents
+    cache->clear();
+    {
+        CacheFile file = cache->open(path, "r");
+        CHECK(!file.wasCacheHit());
+        CHECK(readAll(file) == contents);
+    }
+    written.wait();
+    CHECK(readDisk(path) == contents);
+    CHECK(readDisk(clean) == "clean");
+    CHECK(cache->getDiskWriteCount() == 1);
+    bool tempLeft = false;
+    for (const auto& file : fs::directory_iterator(TEST_DIR)) {
+        tempLeft = tempLeft || file.path().filename().string().find(".cache-") != std::string::npos;
+    }
+    CHECK(!tempLeft);
+    cache->setIoLimits(IoClass::WriteBack, IoClassLimits());
+}
+
+// Opens path until it reads expected, for up to two seconds
+bool waitForContents(ContentAwareCache& cache, const std::string& path, const std::string& expected) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < deadline) {
+        CacheFile file = cache.open(path, "r");
+        if (file && readAll(file) == expected) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+// Stale hits are served at once, and one background refresh brings in the new contents
+void testStaleWhileRevalidate() {
+    std::string path = writeTestFile("settings.swr", "version 1");
+    auto cache = std::make_shared<ContentAwareCache>(16 * 1024 * 1024);
+    cache->setRevalidation(".swr", std::chrono::milliseconds(100), std::chrono::seconds(10));
+
+    CHECK(cache->open(path, "r").isOpen());
+    writeTestFile("settings.swr", "version 2, longer");
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+    {
+        CacheFile file = cache->open(path, "r");
+        CHECK(file.wasCacheHit());
+        CHECK(readAll(file) == "version 1");
+    }
+    CHECK(waitForContents(*cache, path, "version 2, longer"));
+    CHECK(cache->getDiskReadCount() == 2);
+}
+
+// Past the stale window a hit checks the disk first; the cache's own writes are not changes
+void testBlockingRevalidation() {
+    std::string path = writeTestFile("checked.swr", "version 1");
+    auto cache = std::make_shared<ContentAwareCache>(16 * 1024 * 1024);
+    cache->setRevalidation(".swr", std::chrono::milliseconds(100), std::chrono::milliseconds(0));
+
+    CHECK(cache->open(path, "r").isOpen());
+    {
+        CacheFile writer = cache->open(path, "w");
+        CHECK(writer.write("version 2", 1, 9) == 9);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    {
+        CacheFile file = cache->open(path, "r");
+        CHECK(file.wasCacheHit());
+        CHECK(readAll(file) == "version 2");
+    }
+
+    writeTestFile("checked.swr", "version 3, from outside");
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    {
+        CacheFile file = cache->open(path, "r");
+        CHECK(!file.wasCacheHit());
+        CHECK(readAll(file) == "version 3, from outside");
+    }
+    CHECK(cache->getDiskReadCount() == 2);
+}
+
+// A refresh that finds the file gone evicts the stale entry instead of serving it on
+void testFailedRefreshEvicts() {
+    std::string path = writeTestFile("removed.swr", "old contents");
+    auto cache = std::make_shared<ContentAwareCache>(16 * 1024 * 1024);
+    cache->setRevalidation(".swr", std::chrono::milliseconds(100), std::chrono::seconds(10));
+
+    CHECK(cache->open(path, "r").isOpen());
+    fs::remove(path);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+    {
+        CacheFile file = cache->open(path, "r");
+        CHECK(readAll(file) == "old contents");
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (cache->getCacheEntryCount() > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK(cache->getCacheEntryCount() == 0);
+    CHECK(!cache->open(path, "r").isOpen());
+    CHECK(cache->getZombieBytes() == 0);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Content-Aware Cache Feature Checks" << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    fs::remove_all(TEST_DIR);
+    fs::create_directories(TEST_DIR);
+
+    const std::vector<std::pair<std::string, std::function<void()>>> tests = {
+        {"NUMA node lists with gaps", testNumaNodeList},
+        {"executor shutdown with queued work", testExecutorShutdownWithQueuedWork},
+        {"executor released by its own task", testExecutorReleasedByItsOwnTask},
+        {"trace thread ids per recorder", testTraceThreadIdsPerRecorder},
+        {"path index tombstones and resizing", testPathIndexTombstonesAndResize},
+        {"arena compaction", testArenaCompaction},
+        {"file type table ids", testFileTypeTable},
+        {"I/O scheduler priority and rate limits", testIoSchedulerPriorityAndLimits},
+        {"throttled miss does not block hits", testThrottledMissDoesNotBlockHits},
+        {"concurrent misses read once", testConcurrentMissesReadOnce},
+        {"open mode table", testOpenModeTable},
+        {"every mode opens an empty file", testEmptyFileModes},
+        {"snapshot isolation across publishes", testSnapshotIsolation},
+        {"concurrent appenders keep both appends", testConcurrentAppenders},
+        {"replicas released on eviction", testReplicaReleasedOnEviction},
+        {"held bytes return to zero", testZombieBytesReleased},
+        {"write-back replaces whole files", testWriteBackReplacesWholeFiles},
+        {"stale-while-revalidate refresh", testStaleWhileRevalidate},
+        {"blocking revalidation past the stale window", testBlockingRevalidation},
+        {"failed refresh evicts the stale entry", testFailedRefreshEvicts},
+    };
+
+    for (const auto& test : tests) {
+        int failedBefore = failedChecks;
+        std::cout << "  " << test.first << std::endl;
+        test.second();
+        if (failedChecks != failedBefore) {
+            std::cout << "    (" << (failedChecks - failedBefore) << " failed)" << std::endl;
+        }
+    }
+
+    fs::remove_all(TEST_DIR);
+
+    if (failedChecks > 0) {
+        std::cout << failedChecks << " check(s) failed." << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,333 @@
+// workload_generator.h
+#ifndef WORKLOAD_GENERATOR_H
+#define WORKLOAD_GENERATOR_H
+
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+#include <filesystem>
+#include <numeric>
+#include <cmath>
+#include <cstdint>
+
+// File type description used to generate test data
+struct TestFileTypeInfo {
+    std::string extension;
+    size_t minSize;
+    size_t maxSize;
+    float importance;
+};
+
+// Various file types with different size ranges and importance
+inline std::vector<TestFileTypeInfo> defaultTestFileTypes() {
+    return {
+        {".cfg", 1 * 1024, 10 * 1024, 0.9f},      // Small config files (high importance)
+        {".xml", 5 * 1024, 50 * 1024, 0.8f},      // Medium XML files (high importance)
+        {".json", 2 * 1024, 30 * 1024, 0.8f},     // Small-medium JSON files (high importance)
+        {".log", 100 * 1024, 500 * 1024, 0.6f},   // Larger log files (medium importance)
+        {".txt", 1 * 1024, 100 * 1024, 0.7f},     // Text files of various sizes (medium importance)
+        {".dat", 200 * 1024, 1024 * 1024, 0.4f},  // Large data files (lower importance)
+        {".bin", 500 * 1024, 2 * 1024 * 1024, 0.3f}, // Large binary files (lower importance)
+        {".tmp", 10 * 1024, 100 * 1024, 0.2f}     // Temporary files (lowest importance)
+    };
+}
+
+// Zipf(alpha) sampler over ranks 0..n-1 (rank 0 most popular). Uses only raw
+// mt19937 output, so sequences are identical across standard libraries.
+class ZipfSampler {
+private:
+    std::vector<double> cdf;
+    
+public:
+    ZipfSampler(size_t n, double alpha) : cdf(n) {
+        double sum = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), alpha);
+            cdf[i] = sum;
+        }
+        for (auto& value : cdf) {
+            value /= sum;
+        }
+    }
+    
+    size_t operator()(std::mt19937& rng) const {
+        double u = (rng() + 0.5) / 4294967296.0;
+        size_t rank = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+        return std::min(rank, cdf.size() - 1);
+    }
+};
+
+// Enhanced workload generator with realistic patterns
+class WorkloadGenerator {
+private:
+    std::mt19937 rng;
+    const std::vector<std::string>& files;
+    std::vector<std::string> fileTypes; // Store file extensions
+    
+    // Uniform index in [0, n) from raw generator output (portable across standard libraries)
+    size_t uniformIndex(size_t n) {
+        return static_cast<size_t>((static_cast<uint64_t>(rng()) * n) >> 32);
+    }
+    
+    // Random permutation of all file indices, so popularity is independent of type and order
+    std::vector<size_t> shuffledFileIndices() {
+        std::vector<size_t> order(files.size());
+        std::iota(order.begin(), order.end(), 0);
+        for (size_t i = order.size(); i > 1; i--) {
+            std::swap(order[i - 1], order[uniformIndex(i)]);
+        }
+        return order;
+    }
+    
+public:
+    // Runs with the same seed and file set produce the same workloads
+    WorkloadGenerator(const std::vector<std::string>& fileSet, unsigned seed = std::random_device{}()) 
+        : rng(seed), files(fileSet) {
+        
+        // Extract file types from paths
+        for (const auto& file : files) {
+            std::filesystem::path path(file);
+            fileTypes.push_back(path.extension().string());
+        }
+    }
+    
+    // Generate workload with three phases to simulate real application behavior
+    std::vector<std::string> generateRealisticWorkload(size_t totalAccesses) {
+        std::vector<std::string> workload;
+        
+        // Phase 1 (30%): Application startup - config files loaded, initial resources accessed
+        size_t startupPhase = totalAccesses * 0.3;
+        workload.reserve(totalAccesses);
+        
+        // Config files accessed first
+        for (size_t i = 0; i < files.size(); i++) {
+            if (fileTypes[i] == ".cfg" || fileTypes[i] == ".json" || fileTypes[i] == ".xml") {
+                // Access config files multiple times during startup
+                for (int j = 0; j < 5 && workload.size() < startupPhase; j++) {
+                    workload.push_back(files[i]);
+                }
+            }
+        }
+        
+        // Fill remaining startup phase with random accesses
+        std::uniform_int_distribution<size_t> fileDist(0, files.size() - 1);
+        while (workload.size() < startupPhase) {
+            workload.push_back(files[fileDist(rng)]);
+        }
+        
+        // Phase 2 (60%): Normal operation - locality with occasional bursts
+        size_t operationPhase = totalAccesses * 0.6;
+        size_t normalOpEnd = startupPhase + operationPhase;
+        
+        // Set up clusters of related file accesses
+        size_t clusterSize = 5;
+        while (workload.size() < normalOpEnd) {
+            // Choose a random starting file
+            size_t baseFile = fileDist(rng);
+            
+            // Create a cluster of accesses around this file and similar types
+            for (size_t i = 0; i < clusterSize && workload.size() < normalOpEnd; i++) {
+                // Sometimes access the base file
+                if (i % 2 == 0) {
+                    workload.push_back(files[baseFile]);
+                } else {
+                    // Find a file with the same extension
+                    std::string targetExt = fileTypes[baseFile];
+                    std::vector<size_t> sameTypeFiles;
+                    
+                    for (size_t j = 0; j < files.size(); j++) {
+                        if (fileTypes[j] == targetExt) {
+                            sameTypeFiles.push_back(j);
+                        }
+                    }
+                    
+                    if (!sameTypeFiles.empty()) {
+                        std::uniform_int_distribution<size_t> sameDist(0, sameTypeFiles.size() - 1);
+                        workload.push_back(files[sameTypeFiles[sameDist(rng)]]);
+                    } else {
+                        workload.push_back(files[fileDist(rng)]);
+                    }
+                }
+            }
+            
+            // Occasionally access some random files (context switch)
+            if (std::uniform_real_distribution<float>(0, 1)(rng) < 0.3) {
+                for (size_t i = 0; i < 3 && workload.size() < normalOpEnd; i++) {
+                    workload.push_back(files[fileDist(rng)]);
+                }
+            }
+        }
+        
+        // Phase 3 (10%): Application wind-down - log files, cleanup
+        while (workload.size() < totalAccesses) {
+            // Higher probability of accessing log files
+            bool accessLog = std::uniform_real_distribution<float>(0, 1)(rng) < 0.6;
+            
+            if (accessLog) {
+                // Find and access a log file
+                std::vector<size_t> logFiles;
+                for (size_t i = 0; i < files.size(); i++) {
+                    if (fileTypes[i] == ".log") {
+                        logFiles.push_back(i);
+                    }
+                }
+                
+                if (!logFiles.empty()) {
+                    std::uniform_int_distribution<size_t> logDist(0, logFiles.size() - 1);
+                    workload.push_back(files[logFiles[logDist(rng)]]);
+                } else {
+                    workload.push_back(files[fileDist(rng)]);
+                }
+            } else {
+                // Random access to any file
+                workload.push_back(files[fileDist(rng)]);
+            }
+        }
+        
+        return workload;
+    }
+    
+    // Specific pattern that heavily favors important files
+    std::vector<std::string> generateImportantFilesBurstWorkload(size_t totalAccesses) {
+        std::vector<std::string> workload;
+        workload.reserve(totalAccesses);
+        
+        std::uniform_int_distribution<size_t> fileDist(0, files.size() - 1);
+        
+        // Group files by extension
+        std::unordered_map<std::string, std::vector<size_t>> filesByType;
+        for (size_t i = 0; i < files.size(); i++) {
+            filesByType[fileTypes[i]].push_back(i);
+        }
+        
+        // List of important extensions in order of importance
+        std::vector<std::string> importantExts = {".cfg", ".json", ".xml", ".txt"};
+        
+        size_t pos = 0;
+        while (pos < totalAccesses) {
+            // Random extension burst (70% of accesses)
+            std::string burstExt = importantExts[std::uniform_int_distribution<size_t>(0, importantExts.size() - 1)(rng)];
+            
+            // If we have files of this type
+            if (!filesByType[burstExt].empty()) {
+                // Determine burst length (5-20 accesses)
+                size_t burstLength = std::uniform_int_distribution<size_t>(5, 20)(rng);
+                burstLength = std::min(burstLength, totalAccesses - pos);
+                
+                for (size_t i = 0; i < burstLength; i++) {
+                    // Pick random file of this type
+                    size_t fileIndex = filesByType[burstExt][std::uniform_int_distribution<size_t>(0, filesByType[burstExt].size() - 1)(rng)];
+                    workload.push_back(files[fileIndex]);
+                    pos++;
+                }
+            }
+            
+            // Random accesses (30% of total)
+            size_t randomLength = std::uniform_int_distribution<size_t>(1, 5)(rng);
+            randomLength = std::min(randomLength, totalAccesses - pos);
+            
+            for (size_t i = 0; i < randomLength; i++) {
+                workload.push_back(files[fileDist(rng)]);
+                pos++;
+            }
+        }
+        
+        return workload;
+    }
+    
+    // The generators below return indices into the file set; see toPaths()
+    
+    // Independent accesses with Zipf(alpha) popularity over a random ranking of the files
+    std::vector<size_t> generateZipfWorkload(size_t totalAccesses, double alpha) {
+        std::vector<size_t> ranking = shuffledFileIndices();
+        ZipfSampler zipf(files.size(), alpha);
+        
+        std::vector<size_t> workload;
+        workload.reserve(totalAccesses);
+        for (size_t i = 0; i < totalAccesses; i++) {
+            workload.push_back(ranking[zipf(rng)]);
+        }
+        return workload;
+    }
+    
+    // Zipf(alpha) accesses within a hot set that is replaced by a fresh random
+    // set every shiftInterval accesses; hotFraction of accesses go to the hot set
+    std::vector<size_t> generateHotSetShiftWorkload(size_t totalAccesses, size_t hotSetSize,
+                                                    size_t shiftInterval, double alpha = 1.0,
+                                                    double hotFraction = 0.9) {
+        hotSetSize = std::max<size_t>(1, std::min(hotSetSize, files.size()));
+        shiftInterval = std::max<size_t>(1, shiftInterval);
+        ZipfSampler zipf(hotSetSize, alpha);
+        
+        std::vector<size_t> workload;
+        workload.reserve(totalAccesses);
+        std::vector<size_t> hotSet;
+        for (size_t i = 0; i < totalAccesses; i++) {
+            if (i % shiftInterval == 0) {
+                hotSet = shuffledFileIndices();
+                hotSet.resize(hotSetSize);
+            }
+            if ((rng() + 0.5) / 4294967296.0 < hotFraction) {
+                workload.push_back(hotSet[zipf(rng)]);
+            } else {
+                workload.push_back(uniformIndex(files.size()));
+            }
+        }
+        return workload;
+    }
+    
+    // Zipf(alpha) accesses to a fixed hot set, interrupted every scanInterval
+    // accesses by one sequential pass over the whole file set
+    std::vector<size_t> generateScanWithHotSetWorkload(size_t totalAccesses, size_t hotSetSize,
+                                                       size_t scanInterval, double alpha = 1.0) {
+        hotSetSize = std::max<size_t>(1, std::min(hotSetSize, files.size()));
+        scanInterval = std::max<size_t>(1, scanInterval);
+        std::vector<size_t> hotSet = shuffledFileIndices();
+        hotSet.resize(hotSetSize);
+        ZipfSampler zipf(hotSetSize, alpha);
+        
+        std::vector<size_t> workload;
+        workload.reserve(totalAccesses);
+        size_t sinceScan = 0;
+        while (workload.size() < totalAccesses) {
+            if (sinceScan == scanInterval) {
+                for (size_t f = 0; f < files.size() && workload.size() < totalAccesses; f++) {
+                    workload.push_back(f);
+                }
+                sinceScan = 0;
+                continue;
+            }
+            workload.push_back(hotSet[zipf(rng)]);
+            sinceScan++;
+        }
+        return workload;
+    }
+    
+    // Cyclic pass over loopLength files in a fixed random order; with a loop
+    // larger than the cache, LRU and FIFO miss on every access
+    std::vector<size_t> generateLoopWorkload(size_t totalAccesses, size_t loopLength) {
+        loopLength = std::max<size_t>(1, std::min(loopLength, files.size()));
+        std::vector<size_t> loop = shuffledFileIndices();
+        loop.resize(loopLength);
+        
+        std::vector<size_t> workload;
+        workload.reserve(totalAccesses);
+        for (size_t i = 0; i < totalAccesses; i++) {
+            workload.push_back(loop[i % loopLength]);
+        }
+        return workload;
+    }
+    
+    std::vector<std::string> toPaths(const std::vector<size_t>& indices) const {
+        std::vector<std::string> paths;
+        paths.reserve(indices.size());
+        for (size_t index : indices) {
+            paths.push_back(files[index]);
+        }
+        return paths;
+    }
+};
+
+#endif // WORKLOAD_GENERATOR_H